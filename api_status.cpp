@@ -0,0 +1,50 @@
+/*
+ * Live counters as JSON, for /api/status
+ */
+
+#include <stdio.h>
+#include "api_status.h"
+
+/*
+ * Write the document, returns its length, 0 when the buffer is too small
+ */
+int apiStatusJson(const apiStatus *s, char *buf, size_t size) {
+    int n = snprintf(buf, size,
+                     "{\"status\":\"%s\",\"rssi\":%d,\"temperature\":%d,\"fan\":%d,"
+                     "\"artnet_packets\":%lu,\"sacn_packets\":%lu,\"matched\":%lu,"
+                     "\"queued\":%lu,\"coalesced\":%lu,\"dropped\":%lu,"
+                     "\"lost\":%lu,\"reordered\":%lu,\"duplicates\":%lu,"
+                     "\"artsync\":%s,\"merging\":%s,"
+                     "\"ports\":[{\"universe\":%d,\"frames\":%lu,\"fps\":%lu,\"fps_short\":%lu,\"jitter_max\":%ld,\"late\":%lu}",
+                     s->status, s->rssi, s->temperature, s->fanspeed,
+                     (unsigned long)s->artnetPackets, (unsigned long)s->sacnPackets, (unsigned long)s->matched,
+                     (unsigned long)s->queued, (unsigned long)s->coalesced, (unsigned long)s->dropped,
+                     (unsigned long)s->lost, (unsigned long)s->reordered, (unsigned long)s->duplicates,
+                     s->artsync ? "true" : "false", s->merging ? "true" : "false",
+                     s->universe[0], (unsigned long)s->frames[0], (unsigned long)s->fps, (unsigned long)s->fpsShort,
+                     (long)s->jitterMax, (unsigned long)s->late);
+    if ((n < 0) || ((size_t)n >= size)) return 0;
+    int len = n;
+    if (s->ports > 1) {
+        n = snprintf(buf + len, size - len, ",{\"universe\":%d,\"frames\":%lu}", s->universe[1], (unsigned long)s->frames[1]);
+        if ((n < 0) || ((size_t)n >= size - len)) return 0;
+        len += n;
+    }
+    if ((size_t)len + 3 > size) return 0;
+    buf[len++] = ']';
+    buf[len++] = '}';
+    buf[len] = 0;
+    return len;
+}
+
+/*
+ * FNV-1a of the document
+ */
+uint32_t apiEtag(const char *buf, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)buf[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
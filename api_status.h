@@ -0,0 +1,46 @@
+/*
+ * Live counters as JSON, for /api/status
+ *
+ * The values are collected into apiStatus and written into a buffer of
+ * fixed size, no heap is used. The ETag is a hash of the document, so a
+ * poller sending If-None-Match gets a 304 while nothing has changed.
+ * Fields are described in engineering-notes/api-status.txt.
+ */
+
+#ifndef _API_STATUS_H_
+#define _API_STATUS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define API_STATUS_SIZE 768     // enough for all fields at their longest
+
+struct apiStatus {
+    const char *status;
+    int rssi;
+    int temperature;
+    int fanspeed;
+    uint32_t artnetPackets;
+    uint32_t sacnPackets;
+    uint32_t matched;
+    uint32_t queued;
+    uint32_t coalesced;
+    uint32_t dropped;
+    uint32_t lost;
+    uint32_t reordered;
+    uint32_t duplicates;
+    int ports;
+    int universe[2];
+    uint32_t frames[2];
+    uint32_t fps;
+    uint32_t fpsShort;
+    int32_t jitterMax;
+    uint32_t late;
+    bool artsync;
+    bool merging;
+};
+
+int apiStatusJson(const apiStatus *s, char *buf, size_t size);
+uint32_t apiEtag(const char *buf, size_t len);
+
+#endif
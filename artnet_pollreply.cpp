@@ -0,0 +1,181 @@
+/*
+ * ArtPollReply of the node
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "artnet_pollreply.h"
+#include "artnet_udp.h"
+
+// offsets into the reply
+#define PR_IP          10
+#define PR_VERSION     16
+#define PR_NETSWITCH   18
+#define PR_SUBSWITCH   19
+#define PR_STATUS1     23
+#define PR_SHORTNAME   26
+#define PR_LONGNAME    44
+#define PR_NODEREPORT  108
+#define PR_NUMPORTS    172
+#define PR_PORTTYPES   174
+#define PR_GOODOUTPUT  182
+#define PR_SWOUT       190
+#define PR_MAC         201
+#define PR_BINDIP      207
+#define PR_BINDINDEX   211
+#define PR_STATUS2     212
+
+#define PR_COUNTER     (PR_NODEREPORT + 7)   // "#xxxx [" then four digits
+
+artnetPollReply::artnetPollReply() {
+    memset(this->reply, 0, sizeof(this->reply));
+    memset(this->address, 0, sizeof(this->address));
+    memset(this->good, 0, sizeof(this->good));
+    this->ports = 0;
+    this->bound = false;
+    this->counter = 0;
+    this->pending = false;
+    this->dueAt = 0;
+    this->random = 1;
+    this->sentCount = 0;
+}
+
+/*
+ * Build the fixed part of the reply
+ */
+void artnetPollReply::begin(const uint8_t *ip, const uint8_t *mac, uint8_t versionHi, uint8_t versionLo) {
+    memset(this->reply, 0, sizeof(this->reply));
+    memcpy(this->reply, "Art-Net", 8);
+    this->reply[8] = ARTNET_OP_POLLREPLY & 0xff;
+    this->reply[9] = ARTNET_OP_POLLREPLY >> 8;
+    this->setIp(ip);
+    this->reply[14] = ARTNET_PORT & 0xff;
+    this->reply[15] = ARTNET_PORT >> 8;
+    this->reply[PR_VERSION] = versionHi;
+    this->reply[PR_VERSION+1] = versionLo;
+    memcpy(&this->reply[PR_MAC], mac, 6);
+    this->setReport(ARTNET_RC_POWEROK, "OK");
+
+    // seed the back-off from the MAC address, so nodes differ
+    this->random = (mac[2] << 24) | (mac[3] << 16) | (mac[4] << 8) | mac[5];
+    if (this->random == 0) this->random = 1;
+}
+
+void artnetPollReply::setIp(const uint8_t *ip) {
+    memcpy(&this->reply[PR_IP], ip, 4);
+    memcpy(&this->reply[PR_BINDIP], ip, 4);
+}
+
+/*
+ * Short and long name, only rewritten when they change
+ */
+void artnetPollReply::setName(const char *name) {
+    if (strncmp((const char *)&this->reply[PR_LONGNAME], name, 63) == 0) return;
+    memset(&this->reply[PR_SHORTNAME], 0, 18 + 64);
+    strncpy((char *)&this->reply[PR_SHORTNAME], name, 17);
+    strncpy((char *)&this->reply[PR_LONGNAME], name, 63);
+}
+
+/*
+ * Output ports and their Port-Addresses, written by next()
+ */
+void artnetPollReply::setPorts(int ports, const uint16_t *address) {
+    if (ports > ARTPOLL_PORTS) ports = ARTPOLL_PORTS;
+    this->ports = ports;
+    this->bound = false;
+    for (int port = 0; port < ports; port++) {
+        this->address[port] = address[port];
+        if ((address[port] >> 4) != (address[0] >> 4)) this->bound = true;
+    }
+}
+
+void artnetPollReply::setGoodOutput(int port, uint8_t good) {
+    if ((port >= 0) && (port < ARTPOLL_PORTS)) this->good[port] = good;
+}
+
+/*
+ * Ports first..first+count-1 into the reply, they share Net/Sub
+ */
+void artnetPollReply::writePorts(int first, int count, uint8_t bindIndex) {
+    uint16_t address = (count > 0) ? this->address[first] : 0;
+    this->reply[PR_NUMPORTS+1] = count;
+    this->reply[PR_NETSWITCH] = (address >> 8) & 0x7f;
+    this->reply[PR_SUBSWITCH] = (address >> 4) & 0x0f;
+    for (int i = 0; i < ARTPOLL_PORTS; i++) {
+        bool used = i < count;
+        this->reply[PR_PORTTYPES+i] = used ? 0x80 : 0x00;   // DMX512 output
+        this->reply[PR_GOODOUTPUT+i] = used ? this->good[first+i] : 0x00;
+        this->reply[PR_SWOUT+i] = used ? this->address[first+i] & 0x0f : 0x00;
+    }
+    this->reply[PR_BINDINDEX] = bindIndex;
+}
+
+void artnetPollReply::setStatus(uint8_t status1, uint8_t status2) {
+    this->reply[PR_STATUS1] = status1;
+    this->reply[PR_STATUS2] = status2;
+}
+
+/*
+ * NodeReport "#xxxx [yyyy] text", the counter is kept
+ */
+void artnetPollReply::setReport(uint16_t code, const char *text) {
+    char *r = (char *)&this->reply[PR_NODEREPORT];
+    memset(r, 0, 64);
+    snprintf(r, 64, "#%04x [0000] %s", code, text);
+    this->writeCounter();
+}
+
+/*
+ * Four digit counter in place in the NodeReport
+ */
+void artnetPollReply::writeCounter() {
+    uint16_t c = this->counter;
+    for (int i = 3; i >= 0; i--) {
+        this->reply[PR_COUNTER+i] = '0' + c % 10;
+        c /= 10;
+    }
+}
+
+/*
+ * An ArtPoll arrived, the reply goes out after a random delay
+ */
+void artnetPollReply::requested(uint32_t now) {
+    if (this->pending) return;
+    this->random ^= this->random << 13;
+    this->random ^= this->random >> 17;
+    this->random ^= this->random << 5;
+    this->dueAt = now + this->random % ARTPOLL_BACKOFF;
+    this->pending = true;
+}
+
+bool artnetPollReply::due(uint32_t now) {
+    return this->pending && ((int32_t)(now - this->dueAt) >= 0);
+}
+
+/*
+ * Number of replies that answer one ArtPoll
+ */
+int artnetPollReply::replies() {
+    return (this->bound) ? this->ports : 1;
+}
+
+/*
+ * Reply index of replies() to send now, counts it
+ * Bound replies carry one port each, BindIndex 1 is the root device
+ */
+const uint8_t *artnetPollReply::next(int index) {
+    if (this->bound) this->writePorts(index, 1, index + 1);
+    else this->writePorts(0, this->ports, 1);
+    this->pending = false;
+    this->counter = (this->counter + 1) % 10000;
+    this->writeCounter();
+    this->sentCount++;
+    return this->reply;
+}
+
+/*
+ * Replies sent
+ */
+uint32_t artnetPollReply::sent() {
+    return this->sentCount;
+}
@@ -0,0 +1,62 @@
+/*
+ * ArtPollReply of the node
+ *
+ * The 239 byte reply (see engineering-notes/artnet-pollreply.txt) is kept
+ * in a static buffer. It is built once, afterwards only the fields that
+ * change are rewritten: the NodeReport counter on every reply, GoodOutput,
+ * Status1/Status2 and the names when they are set to something new.
+ *
+ * An ArtPoll schedules the reply after a random delay of up to
+ * ARTPOLL_BACKOFF, so hundreds of nodes do not answer in the same instant.
+ * Polls arriving while a reply is pending are answered by that reply.
+ *
+ * The reply has one NetSwitch/SubSwitch for all its ports. When the ports
+ * differ in Net or Sub, each port goes out in a reply of its own, told
+ * apart by the BindIndex, so every port shows its own Port-Address.
+ */
+
+#ifndef _ARTNET_POLLREPLY_H_
+#define _ARTNET_POLLREPLY_H_
+
+#include <stdint.h>
+
+#define ARTNET_POLLREPLY_SIZE 239
+#define ARTPOLL_BACKOFF 1000       // ms, longest random reply delay
+#define ARTPOLL_PORTS 4
+
+#define ARTNET_RC_POWEROK 0x0001
+
+class artnetPollReply {
+    public:
+        artnetPollReply();
+
+        void begin(const uint8_t *ip, const uint8_t *mac, uint8_t versionHi, uint8_t versionLo);
+        void setIp(const uint8_t *ip);
+        void setName(const char *name);
+        void setPorts(int ports, const uint16_t *address);
+        void setGoodOutput(int port, uint8_t good);
+        void setStatus(uint8_t status1, uint8_t status2);
+        void setReport(uint16_t code, const char *text);
+        void requested(uint32_t now);
+        bool due(uint32_t now);
+        int replies();
+        const uint8_t *next(int index);
+        uint32_t sent();
+
+    private:
+        uint8_t reply[ARTNET_POLLREPLY_SIZE];
+        int ports;
+        uint16_t address[ARTPOLL_PORTS];
+        uint8_t good[ARTPOLL_PORTS];
+        bool bound;             // ports differ in Net/Sub, one reply per port
+        uint16_t counter;       // NodeReport counter
+        bool pending;
+        uint32_t dueAt;
+        uint32_t random;        // xorshift state for the back-off
+        uint32_t sentCount;
+
+        void writeCounter();
+        void writePorts(int first, int count, uint8_t bindIndex);
+};
+
+#endif
@@ -0,0 +1,128 @@
+/*
+ * Receive ring for Art-Net frames
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "artnet_ring.h"
+#include "dmx_frames.h"
+
+#define RING_MASK (ARTNET_RING_SIZE - 1)
+#define RING_NONE 0xff
+
+artnetRing::artnetRing() {
+    this->head = 0;
+    this->tail = 0;
+    this->claimed = RING_NONE;
+    this->reserved = NULL;
+    this->reservedUniverse = 0;
+    this->reservedSource = 0;
+    this->acceptedCount = 0;
+    this->coalescedCount = 0;
+    this->droppedCount = 0;
+}
+
+/*
+ * Allocate the slot buffers
+ */
+void artnetRing::begin() {
+    for (int i = 0; i < ARTNET_RING_SIZE; i++) {
+        this->slot[i].universe = 0;
+        this->slot[i].length = 0;
+        this->slot[i].sequence = 0;
+        this->slot[i].source = 0;
+        this->slot[i].data = (uint8_t *)malloc(FRAME_SIZE);
+    }
+}
+
+/*
+ * Queue a frame, producer side
+ * A pending frame of the same universe and source is replaced (coalesced), if the ring
+ * is full the frame is dropped and false returned
+ */
+bool artnetRing::push(uint16_t universe, uint32_t source, uint16_t length, uint8_t sequence, const uint8_t *data) {
+    uint8_t *buf = this->reserve(universe, source);
+    if (buf == NULL) return false;
+    if (length > FRAME_SIZE) length = FRAME_SIZE;
+    memcpy(buf, data, length);
+    this->commit(length, sequence);
+    return true;
+}
+
+/*
+ * Buffer of FRAME_SIZE bytes to receive a frame of universe from source
+ * in place, NULL if the ring is full. The frame is queued by commit().
+ */
+uint8_t *artnetRing::reserve(uint16_t universe, uint32_t source) {
+    uint8_t h = this->head;
+
+    this->reserved = NULL;
+    for (uint8_t i = this->tail; i != h; i++) {
+        uint8_t idx = i & RING_MASK;
+        if ((this->slot[idx].universe == universe) && (this->slot[idx].source == source) && (idx != this->claimed)) {
+            this->reserved = &this->slot[idx];
+            this->coalescedCount++;
+            break;
+        }
+    }
+    if (this->reserved == NULL) {
+        if ((uint8_t)(h - this->tail) >= ARTNET_RING_SIZE) {
+            this->droppedCount++;
+            return NULL;
+        }
+        this->reserved = &this->slot[h & RING_MASK];
+        this->acceptedCount++;
+    }
+    this->reservedUniverse = universe;
+    this->reservedSource = source;
+    return this->reserved->data;
+}
+
+/*
+ * Queue the frame filled in after reserve()
+ */
+void artnetRing::commit(uint16_t length, uint8_t sequence) {
+    globalStruct *s = this->reserved;
+    if (s == NULL) return;
+    uint8_t h = this->head;
+
+    s->sequence = sequence;
+    s->length = (length > FRAME_SIZE) ? FRAME_SIZE : length;
+    if (s == &this->slot[h & RING_MASK]) {
+        s->universe = this->reservedUniverse;
+        s->source = this->reservedSource;
+        this->head = h + 1;   // publish the new slot last
+    }
+    this->reserved = NULL;
+}
+
+/*
+ * Oldest pending frame, consumer side, NULL if the ring is empty
+ * The frame stays claimed until pop()
+ */
+globalStruct *artnetRing::front() {
+    uint8_t t = this->tail;
+    if (t == this->head) return NULL;
+    this->claimed = t & RING_MASK;
+    return &this->slot[t & RING_MASK];
+}
+
+/*
+ * Release the frame returned by front()
+ */
+void artnetRing::pop() {
+    this->claimed = RING_NONE;
+    this->tail = this->tail + 1;
+}
+
+uint32_t artnetRing::accepted() {
+    return this->acceptedCount;
+}
+
+uint32_t artnetRing::coalesced() {
+    return this->coalescedCount;
+}
+
+uint32_t artnetRing::dropped() {
+    return this->droppedCount;
+}
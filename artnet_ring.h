@@ -0,0 +1,49 @@
+/*
+ * Receive ring for Art-Net frames
+ *
+ * Bounded single-producer/single-consumer ring between the Art-Net receiver
+ * and the commit into the output frame buffers. Every queued datagram is
+ * drained into the ring in one pass; a frame for a universe that is still
+ * pending from the same sender overwrites the pending one, so only the newest
+ * frame per universe and sender is kept.
+ *
+ * The Art-Net and sACN receive callbacks both run in the context of the
+ * network stack, one after the other, together they are the one producer.
+ */
+
+#ifndef _ARTNET_RING_H_
+#define _ARTNET_RING_H_
+
+#include <stdint.h>
+#include "universe_frame.h"
+
+#define ARTNET_RING_SIZE 4   // pending universes, power of two
+
+class artnetRing {
+    public:
+        artnetRing();
+
+        void begin();
+        bool push(uint16_t universe, uint32_t source, uint16_t length, uint8_t sequence, const uint8_t *data);
+        uint8_t *reserve(uint16_t universe, uint32_t source);
+        void commit(uint16_t length, uint8_t sequence);
+        globalStruct *front();
+        void pop();
+        uint32_t accepted();
+        uint32_t coalesced();
+        uint32_t dropped();
+
+    private:
+        globalStruct slot[ARTNET_RING_SIZE];
+        volatile uint8_t head;      // next slot to fill, written by the producer only
+        volatile uint8_t tail;      // oldest pending slot, written by the consumer only
+        volatile uint8_t claimed;   // slot the consumer is reading, not to be coalesced into
+        globalStruct *reserved;     // slot being filled by the producer
+        uint16_t reservedUniverse;
+        uint32_t reservedSource;
+        uint32_t acceptedCount;
+        uint32_t coalescedCount;
+        uint32_t droppedCount;
+};
+
+#endif
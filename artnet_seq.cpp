@@ -0,0 +1,106 @@
+/*
+ * Sequence checking of received frames
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "artnet_seq.h"
+
+seqTracker::seqTracker() {
+    memset(this->streams, 0, sizeof(this->streams));
+    this->useCount = 0;
+    this->lostTotal = 0;
+    this->reorderedTotal = 0;
+    this->duplicateTotal = 0;
+    this->lastGap = 0;
+}
+
+/*
+ * Check the sequence of a frame, returns SEQ_NEW if it is to be used
+ * source is the key of the sender, ip its address for display
+ * artnet selects the Art-Net numbering 1..255, else sACN 0..255
+ */
+int seqTracker::check(uint16_t universe, uint32_t source, uint32_t ip, uint8_t sequence, bool artnet) {
+    this->lastGap = 0;
+    if (artnet && (sequence == 0)) return SEQ_NEW;   // sender does not number its frames
+
+    seqStream *s = NULL;
+    seqStream *lru = &this->streams[0];
+    for (int i = 0; i < SEQ_STREAMS; i++) {
+        seqStream *t = &this->streams[i];
+        if ((t->source == source) && (t->universe == universe)) {
+            s = t;
+            break;
+        }
+        if ((t->source == 0) || ((lru->source != 0) && (t->lastUse < lru->lastUse))) lru = t;
+    }
+    if (s == NULL) {
+        memset(lru, 0, sizeof(seqStream));
+        lru->universe = universe;
+        lru->source = source;
+        lru->ip = ip;
+        lru->last = sequence;
+        lru->frames = 1;
+        lru->lastUse = ++this->useCount;
+        return SEQ_NEW;
+    }
+    s->lastUse = ++this->useCount;
+    s->ip = ip;
+
+    // distance ahead of the last frame, modulo the sequence range
+    int range = artnet ? 255 : 256;
+    int ahead = (sequence - s->last + range) % range;
+    if (ahead == 0) {
+        s->duplicates++;
+        this->duplicateTotal++;
+        return SEQ_DUPLICATE;
+    }
+    if (ahead >= range - SEQ_LATE_WINDOW) {
+        s->reordered++;
+        this->reorderedTotal++;
+        return SEQ_LATE;
+    }
+    if (ahead <= range / 2) {
+        s->lost += ahead - 1;
+        this->lostTotal += ahead - 1;
+        this->lastGap = ahead - 1;
+    }
+    s->last = sequence;
+    s->frames++;
+    return SEQ_NEW;
+}
+
+/*
+ * Number of entries, free ones included
+ */
+int seqTracker::count() {
+    return SEQ_STREAMS;
+}
+
+/*
+ * Entry i, NULL if it is free
+ */
+const seqStream *seqTracker::stream(int i) {
+    if ((i < 0) || (i >= SEQ_STREAMS) || (this->streams[i].source == 0)) return NULL;
+    return &this->streams[i];
+}
+
+uint32_t seqTracker::lost() {
+    return this->lostTotal;
+}
+
+uint32_t seqTracker::reordered() {
+    return this->reorderedTotal;
+}
+
+uint32_t seqTracker::duplicates() {
+    return this->duplicateTotal;
+}
+
+/*
+ * Frames lost in front of the frame of the last check(), 0 unless it
+ * returned SEQ_NEW after a gap
+ */
+uint8_t seqTracker::gap() {
+    return this->lastGap;
+}
@@ -0,0 +1,59 @@
+/*
+ * Sequence checking of received frames
+ *
+ * Art-Net and sACN number their frames with an 8 bit sequence. Per
+ * universe and sender the last sequence is kept, the sender is the IP
+ * address for Art-Net and the CID for sACN (see sacnCidKey()): a frame that is older than
+ * the last one (reordered on the way) or the same (duplicate) is discarded,
+ * gaps are counted as lost frames. Art-Net counts 1..255 and uses 0 for
+ * "no sequence", sACN counts 0..255. A frame more than SEQ_LATE_WINDOW
+ * behind is taken as a restarted sender and accepted.
+ */
+
+#ifndef _ARTNET_SEQ_H_
+#define _ARTNET_SEQ_H_
+
+#include <stdint.h>
+
+#define SEQ_STREAMS 8         // universe/sender pairs tracked
+#define SEQ_LATE_WINDOW 20    // as E1.31 6.7.2
+
+// result of seqTracker::check()
+#define SEQ_NEW       0
+#define SEQ_DUPLICATE 1
+#define SEQ_LATE      2
+
+struct seqStream {
+    uint16_t universe;
+    uint32_t source;       // key of the sender, 0 for a free entry
+    uint32_t ip;           // IPv4 address of the sender, network order
+    uint8_t last;
+    uint32_t lastUse;      // for LRU replacement
+    uint32_t frames;
+    uint32_t lost;
+    uint32_t reordered;
+    uint32_t duplicates;
+};
+
+class seqTracker {
+    public:
+        seqTracker();
+
+        int check(uint16_t universe, uint32_t source, uint32_t ip, uint8_t sequence, bool artnet);
+        int count();
+        const seqStream *stream(int i);
+        uint32_t lost();
+        uint32_t reordered();
+        uint32_t duplicates();
+        uint8_t gap();
+
+    private:
+        seqStream streams[SEQ_STREAMS];
+        uint32_t useCount;
+        uint32_t lostTotal;
+        uint32_t reorderedTotal;
+        uint32_t duplicateTotal;
+        uint8_t lastGap;       // frames lost before the last frame checked
+};
+
+#endif
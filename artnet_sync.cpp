@@ -0,0 +1,71 @@
+/*
+ * ArtSync, synchronous output across many nodes
+ */
+
+#include "artnet_sync.h"
+
+artnetSync::artnetSync() {
+    this->pending = false;
+    this->lastSync = 0;
+    this->seen = false;
+    this->staged = 0;
+    this->sender = 0;
+    this->syncCount = 0;
+}
+
+/*
+ * An ArtSync packet arrived from IP source, called from the receiver
+ * Returns false if it is ignored, it comes from another controller than
+ * the staged frames
+ */
+bool artnetSync::received(uint32_t now, uint32_t source) {
+    if ((this->sender != 0) && (source != this->sender)) return false;
+    this->lastSync = now;
+    this->seen = true;
+    this->pending = true;
+    this->syncCount++;
+    return true;
+}
+
+/*
+ * Whether frames are to be staged, ArtSync seen within the timeout
+ */
+bool artnetSync::active(uint32_t now) {
+    if (this->seen && ((now - this->lastSync) > ARTSYNC_TIMEOUT)) this->seen = false;
+    return this->seen;
+}
+
+/*
+ * A frame for port from IP source was staged instead of published
+ */
+void artnetSync::stage(int port, uint32_t source) {
+    this->staged |= 1 << port;
+    this->sender = source;
+}
+
+/*
+ * Whether staged frames are to be published now: an ArtSync arrived, or
+ * ArtSync stopped and the node is free running again
+ */
+bool artnetSync::due() {
+    return this->pending || (!this->seen && this->staged);
+}
+
+/*
+ * Take the ports to publish, returns 0 when nothing is due
+ */
+uint8_t artnetSync::commit(uint32_t now) {
+    this->active(now);
+    if (!this->due()) return 0;
+    uint8_t ports = this->staged;
+    this->staged = 0;
+    this->pending = false;
+    return ports;
+}
+
+/*
+ * ArtSync packets received
+ */
+uint32_t artnetSync::syncs() {
+    return this->syncCount;
+}
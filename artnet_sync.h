@@ -0,0 +1,43 @@
+/*
+ * ArtSync, synchronous output across many nodes
+ *
+ * While a controller sends ArtSync, received ArtDmx frames are only staged
+ * in the back buffer of their port. The staged frames of all ports are
+ * published together, and the outputs started, when the next ArtSync
+ * arrives. Without ArtSync for ARTSYNC_TIMEOUT the node falls back to
+ * publishing every frame as it arrives. As Art-Net 4 requires, an ArtSync
+ * from another IP than the sender of the staged frames is ignored.
+ *
+ * Time is passed in by the caller in ms, so the logic runs with a
+ * simulated clock on a host as well.
+ */
+
+#ifndef _ARTNET_SYNC_H_
+#define _ARTNET_SYNC_H_
+
+#include <stdint.h>
+
+#define ARTNET_OP_SYNC 0x5200
+#define ARTSYNC_TIMEOUT 4000   // ms
+
+class artnetSync {
+    public:
+        artnetSync();
+
+        bool received(uint32_t now, uint32_t source);
+        bool active(uint32_t now);
+        void stage(int port, uint32_t source);
+        bool due();
+        uint8_t commit(uint32_t now);
+        uint32_t syncs();
+
+    private:
+        volatile bool pending;     // ArtSync received, not yet committed
+        volatile uint32_t lastSync;
+        bool seen;
+        uint8_t staged;            // ports with a frame waiting for ArtSync
+        volatile uint32_t sender;  // IP of the last staged frame, 0 for none yet
+        uint32_t syncCount;
+};
+
+#endif
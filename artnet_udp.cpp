@@ -0,0 +1,205 @@
+/*
+ * Art-Net receiver on a raw lwIP UDP socket
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "artnet_udp.h"
+#include "dmx_frames.h"
+#include "artnet_sync.h"
+#ifdef ARDUINO
+#include "Arduino.h"
+#endif
+
+static const uint8_t artnetId[8] = { 'A', 'r', 't', '-', 'N', 'e', 't', 0 };
+
+/*
+ * Check an Art-Net packet of len bytes, buf holds at least the first
+ * ARTNET_HEADER bytes of it (or all of a shorter packet).
+ * Returns the opcode, 0 for anything that is not valid Art-Net.
+ * The header of an ArtDmx packet is returned in dmx.
+ */
+uint16_t artnetParse(const uint8_t *buf, uint16_t len, artnetDmx *dmx) {
+    if ((len < 10) || (memcmp(buf, artnetId, sizeof(artnetId)) != 0)) return 0;
+    uint16_t opcode = buf[8] | (buf[9] << 8);
+
+    if (opcode == ARTNET_OP_DMX) {
+        if (len < ARTNET_HEADER) return 0;
+        if (buf[11] < ARTNET_PROTOCOL) return 0;
+        uint16_t length = (buf[16] << 8) | buf[17];
+        if ((length < 2) || (length > FRAME_SIZE) || (len < ARTNET_HEADER + length)) return 0;
+        dmx->sequence = buf[12];
+        dmx->physical = buf[13];
+        dmx->universe = ((buf[15] & 0x7f) << 8) | buf[14];
+        dmx->length = length;
+    }
+    return opcode;
+}
+
+/*
+ * Copy len bytes starting at offset out of a pbuf chain
+ * Returns the number of bytes copied
+ */
+uint16_t artnetCopy(const struct pbuf *p, uint16_t offset, uint8_t *dst, uint16_t len) {
+    uint16_t done = 0;
+    for (; (p != NULL) && (done < len); p = p->next) {
+        if (offset >= p->len) {
+            offset -= p->len;
+            continue;
+        }
+        uint16_t n = p->len - offset;
+        if (n > len - done) n = len - done;
+        memcpy(dst + done, (const uint8_t *)p->payload + offset, n);
+        done += n;
+        offset = 0;
+    }
+    return done;
+}
+
+#ifdef ARDUINO
+/*
+ * lwIP receive callback, runs in the context of the network stack
+ */
+static void artnetRecv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port) {
+    ((artnetUdp *)arg)->receive(p, ip_addr_get_ip4_u32(addr), millis());
+    pbuf_free(p);
+}
+#endif
+
+artnetUdp::artnetUdp() {
+    this->ring = NULL;
+    this->filter = NULL;
+    this->pollReply = NULL;
+    this->syncCallback = NULL;
+    this->stats = NULL;
+    this->pcb = NULL;
+    this->packetCount = 0;
+    this->invalidCount = 0;
+}
+
+/*
+ * Open the Art-Net port, received frames go into ring
+ */
+bool artnetUdp::begin(artnetRing *ring) {
+    this->ring = ring;
+#ifdef ARDUINO
+    this->pcb = udp_new();
+    if (this->pcb == NULL) return false;
+    if (udp_bind(this->pcb, IP_ADDR_ANY, ARTNET_PORT) != ERR_OK) {
+        udp_remove(this->pcb);
+        this->pcb = NULL;
+        return false;
+    }
+    udp_recv(this->pcb, artnetRecv, this);
+    ip_set_option(this->pcb, SOF_BROADCAST);   // ArtPollReply goes out as broadcast
+#endif
+    return true;
+}
+
+/*
+ * Called with universe, sender and sequence of every ArtDmx packet, the
+ * payload is only copied when it returns true
+ */
+void artnetUdp::setDmxFilter(bool (*filter)(uint16_t universe, uint32_t source, uint8_t sequence)) {
+    this->filter = filter;
+}
+
+/*
+ * ArtPoll schedules this reply, see artnetPollReply
+ */
+void artnetUdp::setPollReply(artnetPollReply *reply) {
+    this->pollReply = reply;
+}
+
+/*
+ * Called for every ArtSync with the address of the sender
+ */
+void artnetUdp::setSync(void (*sync)(uint32_t addr)) {
+    this->syncCallback = sync;
+}
+
+/*
+ * Count every ArtDmx packet per sender in stats
+ */
+void artnetUdp::setStats(sourceStats *stats) {
+    this->stats = stats;
+}
+
+/*
+ * Handle one received datagram from IPv4 address addr (network order), now in ms
+ * The pbuf stays owned by the caller
+ */
+void artnetUdp::receive(struct pbuf *p, uint32_t addr, uint32_t now) {
+    uint8_t header[ARTNET_HEADER];
+    const uint8_t *buf = (const uint8_t *)p->payload;
+    artnetDmx dmx;
+
+    this->packetCount++;
+    // the header is practically always in the first pbuf
+    if (p->len < ARTNET_HEADER) {
+        artnetCopy(p, 0, header, ARTNET_HEADER);
+        buf = header;
+    }
+
+    switch (artnetParse(buf, p->tot_len, &dmx)) {
+        case ARTNET_OP_DMX:
+            if (this->stats) this->stats->record(addr, dmx.universe, false, dmx.sequence, p->tot_len, now);
+            if (this->filter && !this->filter(dmx.universe, addr, dmx.sequence)) break;
+            if (this->ring) {
+                uint8_t *data = this->ring->reserve(dmx.universe, addr);
+                if (data == NULL) break;
+                if (p->len >= ARTNET_HEADER + dmx.length) {
+                    memcpy(data, buf + ARTNET_HEADER, dmx.length);
+                } else {
+                    artnetCopy(p, ARTNET_HEADER, data, dmx.length);
+                }
+                this->ring->commit(dmx.length, dmx.sequence);
+            }
+            break;
+        case ARTNET_OP_POLL:
+            if (this->pollReply) this->pollReply->requested(now);
+            break;
+        case ARTNET_OP_SYNC:
+            if (this->syncCallback) this->syncCallback(addr);
+            break;
+        case 0:
+            this->invalidCount++;
+            break;
+    }
+}
+
+/*
+ * Send a packet from the Art-Net port to addr (network order)
+ */
+bool artnetUdp::send(const uint8_t *data, uint16_t length, uint32_t addr) {
+#ifdef ARDUINO
+    if (this->pcb == NULL) return false;
+    struct pbuf *q = pbuf_alloc(PBUF_TRANSPORT, length, PBUF_RAM);
+    if (q == NULL) return false;
+    memcpy(q->payload, data, length);
+    ip_addr_t to;
+    ip_addr_set_ip4_u32(&to, addr);
+    err_t err = udp_sendto(this->pcb, q, &to, ARTNET_PORT);
+    pbuf_free(q);
+    return err == ERR_OK;
+#else
+    (void)data;
+    (void)length;
+    (void)addr;
+    return true;
+#endif
+}
+
+/*
+ * Datagrams received on the Art-Net port
+ */
+uint32_t artnetUdp::packets() {
+    return this->packetCount;
+}
+
+/*
+ * Datagrams that were not valid Art-Net
+ */
+uint32_t artnetUdp::invalid() {
+    return this->invalidCount;
+}
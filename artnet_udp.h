@@ -0,0 +1,75 @@
+/*
+ * Art-Net receiver on a raw lwIP UDP socket
+ *
+ * The receive callback runs on the pbuf lwIP hands over: the Art-Net header
+ * and the universe are checked in place, and the DMX payload of a wanted
+ * universe is copied once, straight into a slot of the receive ring. From
+ * there it gets to the output port by a buffer swap, see handleArtnet().
+ *
+ * The parser only needs struct pbuf. Without ARDUINO a minimal pbuf is
+ * declared here so the parser can be built and checked on a Linux host.
+ */
+
+#ifndef _ARTNET_UDP_H_
+#define _ARTNET_UDP_H_
+
+#include <stdint.h>
+#include "artnet_ring.h"
+#include "source_stats.h"
+#include "artnet_pollreply.h"
+
+#ifdef ARDUINO
+#include "lwip/udp.h"
+#else
+struct pbuf {
+    struct pbuf *next;
+    void *payload;
+    uint16_t tot_len;   // length of this and all following pbufs
+    uint16_t len;       // length of this pbuf
+};
+#endif
+
+#define ARTNET_PORT 0x1936
+#define ARTNET_PROTOCOL 14
+#define ARTNET_HEADER 18          // ArtDmx header, the data follows
+#define ARTNET_OP_POLL 0x2000
+#define ARTNET_OP_POLLREPLY 0x2100
+#define ARTNET_OP_DMX 0x5000
+
+// Header fields of an ArtDmx packet
+struct artnetDmx {
+    uint16_t universe;   // 15 bit Port-Address
+    uint16_t length;
+    uint8_t sequence;
+    uint8_t physical;
+};
+
+uint16_t artnetParse(const uint8_t *buf, uint16_t len, artnetDmx *dmx);
+uint16_t artnetCopy(const struct pbuf *p, uint16_t offset, uint8_t *dst, uint16_t len);
+
+class artnetUdp {
+    public:
+        artnetUdp();
+
+        bool begin(artnetRing *ring);
+        void setDmxFilter(bool (*filter)(uint16_t universe, uint32_t source, uint8_t sequence));
+        void setPollReply(artnetPollReply *reply);
+        void setSync(void (*sync)(uint32_t addr));
+        void setStats(sourceStats *stats);
+        void receive(struct pbuf *p, uint32_t addr, uint32_t now);
+        bool send(const uint8_t *data, uint16_t length, uint32_t addr);
+        uint32_t packets();
+        uint32_t invalid();
+
+    private:
+        artnetRing *ring;
+        bool (*filter)(uint16_t universe, uint32_t source, uint8_t sequence);
+        artnetPollReply *pollReply;
+        void (*syncCallback)(uint32_t addr);
+        sourceStats *stats;
+        struct udp_pcb *pcb;
+        uint32_t packetCount;
+        uint32_t invalidCount;
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Triple buffered universe frames
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "dmx_frames.h"
+#include "dmx_hw.h"
+
+#define FRAME_NEW 0x80   // flag in middleIdx, frame published but not yet sent
+
+/*
+ * Exchange the shared middle index, safe against the transmitter interrupt
+ */
+static inline uint8_t ICACHE_RAM_ATTR frameXchg(volatile uint8_t *middle, uint8_t v) {
+#ifdef ARDUINO
+    uint32_t savedPS = xt_rsil(15);
+    uint8_t old = *middle;
+    *middle = v;
+    xt_wsr_ps(savedPS);
+    return old;
+#else
+    return __atomic_exchange_n(middle, v, __ATOMIC_ACQ_REL);
+#endif
+}
+
+frameBuffer::frameBuffer() {
+    this->backIdx = 0;
+    this->middleIdx = 1;
+    this->frontIdx = 2;
+    this->publishedSeq = 0;
+    this->sentSeq = 0;
+    this->usedChannels = 0;
+}
+
+/*
+ * Allocate and clear the buffers
+ */
+void frameBuffer::begin() {
+    for (int i = 0; i < FRAME_BUFFERS; i++) {
+        this->frame[i].universe = 0;
+        this->frame[i].sequence = 0;
+        this->frame[i].source = 0;
+        this->frame[i].length = FRAME_SIZE;
+        this->frame[i].data = (uint8_t *)malloc(FRAME_SIZE);
+        memset(this->frame[i].data, 0, FRAME_SIZE);
+        this->number[i] = 0;
+    }
+}
+
+/*
+ * Buffer for the receiver to fill, the content is undefined
+ */
+globalStruct *frameBuffer::back() {
+    return &this->frame[this->backIdx];
+}
+
+/*
+ * Back buffer pre-loaded with the latest frame, for partial updates
+ */
+globalStruct *frameBuffer::edit() {
+    globalStruct *b = &this->frame[this->backIdx];
+    globalStruct *l = this->latest();
+    if (b != l) {
+        b->universe = l->universe;
+        b->sequence = l->sequence;
+        b->source = l->source;
+        b->length = l->length;
+        memcpy(b->data, l->data, FRAME_SIZE);
+    }
+    return b;
+}
+
+/*
+ * Hand the back buffer over as the latest complete frame
+ * An unsent frame published before is dropped, latest wins
+ */
+void frameBuffer::publish() {
+    globalStruct *b = &this->frame[this->backIdx];
+    // only channels above the current mark need to be looked at
+    for (int i = b->length; i > this->usedChannels; i--) {
+        if (b->data[i-1]) {
+            this->usedChannels = i;
+            break;
+        }
+    }
+    this->number[this->backIdx] = ++this->publishedSeq;
+    this->backIdx = frameXchg(&this->middleIdx, this->backIdx | FRAME_NEW) & ~FRAME_NEW;
+}
+
+/*
+ * Newest complete frame for the transmitter
+ * The frame stays untouched until the next call of acquire()
+ */
+globalStruct * ICACHE_RAM_ATTR frameBuffer::acquire() {
+    if (this->middleIdx & FRAME_NEW) {
+        this->frontIdx = frameXchg(&this->middleIdx, this->frontIdx) & ~FRAME_NEW;
+        this->sentSeq = this->number[this->frontIdx];
+    }
+    return &this->frame[this->frontIdx];
+}
+
+/*
+ * Newest published frame, for display
+ */
+globalStruct *frameBuffer::latest() {
+    uint8_t m = this->middleIdx;
+    if (m & FRAME_NEW) return &this->frame[m & ~FRAME_NEW];
+    return &this->frame[this->frontIdx];
+}
+
+/*
+ * Sequence number of the latest complete frame
+ */
+uint32_t frameBuffer::published() {
+    return this->publishedSeq;
+}
+
+/*
+ * Sequence number of the frame last taken by the transmitter
+ */
+uint32_t frameBuffer::sent() {
+    return this->sentSeq;
+}
+
+/*
+ * Highest channel that was ever non-zero, channels going back to zero
+ * stay included so the fixtures see them drop
+ */
+uint16_t ICACHE_RAM_ATTR frameBuffer::used() {
+    return this->usedChannels;
+}
+
+void frameBuffer::resetUsed() {
+    this->usedChannels = 0;
+}
@@ -0,0 +1,45 @@
+/*
+ * Triple buffered universe frames
+ *
+ * The receiver always writes into the back buffer and publishes it when the
+ * frame is complete, the transmitter always sends the front buffer. Publishing
+ * and acquiring swap buffer indexes atomically at frame boundaries, so a frame
+ * on the wire never mixes old and new channel values.
+ */
+
+#ifndef _DMX_FRAMES_H_
+#define _DMX_FRAMES_H_
+
+#include <stdint.h>
+#include "universe_frame.h"
+
+#define FRAME_BUFFERS 3
+#define FRAME_SIZE 512
+
+class frameBuffer {
+    public:
+        frameBuffer();
+
+        void begin();
+        globalStruct *back();
+        globalStruct *edit();
+        void publish();
+        globalStruct *acquire();
+        globalStruct *latest();
+        uint32_t published();
+        uint32_t sent();
+        uint16_t used();
+        void resetUsed();
+
+    private:
+        globalStruct frame[FRAME_BUFFERS];
+        uint32_t number[FRAME_BUFFERS];   // sequence number of the frame in each buffer
+        uint8_t backIdx;                  // owned by the receiver
+        volatile uint8_t middleIdx;       // shared, FRAME_NEW set when not yet sent
+        uint8_t frontIdx;                 // owned by the transmitter
+        volatile uint32_t publishedSeq;
+        volatile uint32_t sentSeq;
+        volatile uint16_t usedChannels;   // highest channel ever non-zero
+};
+
+#endif
@@ -0,0 +1,226 @@
+/*
+ * Low level hardware access for the DMX output
+ *
+ * All register access of the DMX output goes through the few inline
+ * functions in here. When compiled outside of Arduino (ARDUINO not defined)
+ * a small model of the UART and timer1 is used instead, see dmx_hw_host.cpp,
+ * so the output state machine, byte ordering and line timing can be checked
+ * on a Linux host.
+ */
+
+#ifndef _DMX_HW_H_
+#define _DMX_HW_H_
+
+#include <stdint.h>
+
+#define DMX_UART_FIFO_SIZE 128   // size of the ESP8266 UART TX FIFO
+#define DMX_BIT_US 4             // 250000 baud
+#define DMX_SLOT_US 44           // start bit, 8 data bits, 2 stop bits
+#define DMX_I2S_WORD_US 128      // one 32 bit I2S word at 250000 bit/s
+#define DMX_I2S_RING 512         // words in the DMA ring of the core, 8 buffers of 64
+
+#ifdef ARDUINO
+
+#include "Arduino.h"
+#include "uart_register.h"
+#include "i2s.h"
+
+static inline uint8_t dmxUartTxCount(int uart) {
+    return (READ_PERI_REG(UART_STATUS(uart)) >> UART_TXFIFO_CNT_S) & UART_TXFIFO_CNT;
+}
+
+static inline void dmxUartWrite(int uart, uint8_t b) {
+    WRITE_PERI_REG(UART_FIFO(uart), b);
+}
+
+// The FIFO-empty interrupt fires as soon as less than threshold bytes are left in the FIFO
+static inline void dmxUartTxIntEnable(int uart, uint8_t threshold) {
+    uint32_t conf1 = READ_PERI_REG(UART_CONF1(uart));
+    conf1 &= ~(UART_TXFIFO_EMPTY_THRHD << UART_TXFIFO_EMPTY_THRHD_S);
+    conf1 |= (threshold & UART_TXFIFO_EMPTY_THRHD) << UART_TXFIFO_EMPTY_THRHD_S;
+    WRITE_PERI_REG(UART_CONF1(uart), conf1);
+    WRITE_PERI_REG(UART_INT_CLR(uart), UART_TXFIFO_EMPTY_INT_CLR);
+    SET_PERI_REG_MASK(UART_INT_ENA(uart), UART_TXFIFO_EMPTY_INT_ENA);
+}
+
+static inline void dmxUartTxIntDisable(int uart) {
+    CLEAR_PERI_REG_MASK(UART_INT_ENA(uart), UART_TXFIFO_EMPTY_INT_ENA);
+    WRITE_PERI_REG(UART_INT_CLR(uart), UART_TXFIFO_EMPTY_INT_CLR);
+}
+
+static inline bool dmxUartTxIntPending(int uart) {
+    return READ_PERI_REG(UART_INT_ST(uart)) & UART_TXFIFO_EMPTY_INT_ST;
+}
+
+static inline void dmxUartIntClear(int uart) {
+    WRITE_PERI_REG(UART_INT_CLR(uart), 0xffff);
+}
+
+// UART0 and UART1 share one interrupt, the handler must serve both
+static inline void dmxUartAttach(void (*isr)(void *), void *arg) {
+    ETS_UART_INTR_DISABLE();
+    ETS_UART_INTR_ATTACH(isr, arg);
+    ETS_UART_INTR_ENABLE();
+}
+
+// Force the TX line low (break) or give it back to the UART
+static inline void dmxUartSetBreak(int uart, bool on) {
+    if (on) {
+        SET_PERI_REG_MASK(UART_CONF0(uart), UART_TXD_BRK);
+    } else {
+        CLEAR_PERI_REG_MASK(UART_CONF0(uart), UART_TXD_BRK);
+    }
+}
+
+// timer1 runs single shot at 5MHz (80MHz / 16)
+static inline void dmxTimerAttach(void (*isr)(void)) {
+    timer1_attachInterrupt(isr);
+    timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+}
+
+static inline void dmxTimerArm(uint32_t us) {
+    timer1_write(us * 5);
+}
+
+static inline uint32_t dmxMicros() {
+    return micros();
+}
+
+// Keep the timer and UART interrupts out while loop() changes shared state
+static inline uint32_t dmxIntLock() {
+    return xt_rsil(15);
+}
+
+static inline void dmxIntUnlock(uint32_t savedPS) {
+    xt_wsr_ps(savedPS);
+}
+
+// I2S clocked at 160MHz / (16 * 40) = 250000 bit/s, data out on GPIO3
+// The core also routes WS to GPIO2 and BCK to GPIO15, GPIO2 goes back to UART1
+static inline void dmxI2sBegin(int uartPin) {
+    i2s_begin();
+    i2s_set_dividers(16, 40);
+    pinMode(uartPin, SPECIAL);
+    pinMode(15, INPUT);
+}
+
+static inline bool dmxI2sFull() {
+    return i2s_is_full();
+}
+
+static inline void dmxI2sWrite(uint32_t word) {
+    i2s_write_sample_nb(word);
+}
+
+// Words written but not yet on the line
+static inline uint16_t dmxI2sQueued() {
+    return DMX_I2S_RING - i2s_available();
+}
+
+#else // host model
+
+#define ICACHE_RAM_ATTR
+
+#define DMX_HOST_EVENTS 16384
+
+// One change of the line level, at time t in microseconds
+struct dmxLineEvent {
+    uint32_t t;
+    uint8_t  level;
+};
+
+// Model of one UART: the TX FIFO, the shift register and the line
+struct dmxUartModel {
+    uint8_t  fifo[DMX_UART_FIFO_SIZE];
+    uint8_t  head;
+    uint8_t  count;
+    uint8_t  threshold;
+    bool     intEnabled;
+    bool     brk;          // TXD_BRK set
+    uint16_t shift;        // bits left in the shift register, LSB goes out next
+    uint8_t  shiftBits;
+    uint8_t  level;        // current line level
+};
+
+extern dmxUartModel dmxUartHost[2];
+extern uint32_t dmxHostNow;                          // simulated time in microseconds
+extern dmxLineEvent dmxHostLine[DMX_HOST_EVENTS];    // line transitions of UART1
+extern int dmxHostLineLen;
+
+static inline uint8_t dmxUartTxCount(int uart) {
+    return dmxUartHost[uart].count;
+}
+
+static inline void dmxUartWrite(int uart, uint8_t b) {
+    dmxUartModel *u = &dmxUartHost[uart];
+    if (u->count >= DMX_UART_FIFO_SIZE) return;   // the hardware drops it as well
+    u->fifo[(u->head + u->count) % DMX_UART_FIFO_SIZE] = b;
+    u->count++;
+}
+
+static inline void dmxUartTxIntEnable(int uart, uint8_t threshold) {
+    dmxUartHost[uart].threshold = threshold;
+    dmxUartHost[uart].intEnabled = true;
+}
+
+static inline void dmxUartTxIntDisable(int uart) {
+    dmxUartHost[uart].intEnabled = false;
+}
+
+static inline bool dmxUartTxIntPending(int uart) {
+    return dmxUartHost[uart].intEnabled && (dmxUartHost[uart].count < dmxUartHost[uart].threshold);
+}
+
+static inline void dmxUartIntClear(int) {
+}
+
+static inline void dmxUartSetBreak(int uart, bool on) {
+    dmxUartHost[uart].brk = on;
+}
+
+void dmxUartAttach(void (*isr)(void *), void *arg);
+void dmxTimerAttach(void (*isr)(void));
+void dmxTimerArm(uint32_t us);
+
+static inline uint32_t dmxMicros() {
+    return dmxHostNow;
+}
+
+static inline uint32_t dmxIntLock() {
+    return 0;
+}
+
+static inline void dmxIntUnlock(uint32_t) {
+}
+
+#define DMX_HOST_I2S_WORDS 4096
+
+extern uint32_t dmxHostI2s[DMX_HOST_I2S_WORDS];   // words written to I2S
+extern int dmxHostI2sLen;
+extern int dmxHostI2sQueued;                      // words waiting in the DMA ring
+
+static inline void dmxI2sBegin(int) {
+}
+
+static inline bool dmxI2sFull() {
+    return dmxHostI2sQueued >= DMX_I2S_RING;
+}
+
+static inline uint16_t dmxI2sQueued() {
+    return dmxHostI2sQueued;
+}
+
+static inline void dmxI2sWrite(uint32_t word) {
+    if (dmxHostI2sLen < DMX_HOST_I2S_WORDS) dmxHostI2s[dmxHostI2sLen++] = word;
+    dmxHostI2sQueued++;
+}
+
+// Reset the model and the timeline
+void dmxHostReset(void);
+// Let us microseconds pass, moving bits onto the line and firing interrupts
+// The I2S DMA ring drains one word every 128us
+void dmxHostRun(uint32_t us);
+
+#endif // ARDUINO
+
+#endif // _DMX_HW_H_
@@ -0,0 +1,104 @@
+/*
+ * Host model of the DMX output hardware, see dmx_hw.h
+ *
+ * Only compiled without ARDUINO. Time advances in steps of one microsecond,
+ * the UART shifts out one bit every 4us and every change of the UART1 line
+ * level is recorded in dmxHostLine, which gives a timeline of the break,
+ * MAB and slot timings. Words written to I2S are logged in dmxHostI2s and
+ * leave the modelled DMA ring at one word every 128us.
+ */
+
+#ifndef ARDUINO
+
+#include <string.h>
+#include "dmx_hw.h"
+
+dmxUartModel dmxUartHost[2];
+uint32_t dmxHostNow = 0;
+dmxLineEvent dmxHostLine[DMX_HOST_EVENTS];
+int dmxHostLineLen = 0;
+uint32_t dmxHostI2s[DMX_HOST_I2S_WORDS];
+int dmxHostI2sLen = 0;
+int dmxHostI2sQueued = 0;
+
+static void (*uartIsr)(void *) = NULL;
+static void *uartArg = NULL;
+static void (*timerIsr)(void) = NULL;
+static bool timerArmed = false;
+static uint32_t timerDue = 0;
+static uint8_t bitUs[2];
+static uint8_t lineLevel = 1;
+
+void dmxUartAttach(void (*isr)(void *), void *arg) {
+    uartIsr = isr;
+    uartArg = arg;
+}
+
+void dmxTimerAttach(void (*isr)(void)) {
+    timerIsr = isr;
+}
+
+void dmxTimerArm(uint32_t us) {
+    timerDue = dmxHostNow + us;
+    timerArmed = true;
+}
+
+void dmxHostReset() {
+    memset(dmxUartHost, 0, sizeof(dmxUartHost));
+    for (int u = 0; u < 2; u++) dmxUartHost[u].level = 1;
+    memset(bitUs, 0, sizeof(bitUs));
+    dmxHostNow = 0;
+    dmxHostLineLen = 0;
+    dmxHostI2sLen = 0;
+    dmxHostI2sQueued = 0;
+    lineLevel = 1;
+    timerArmed = false;
+}
+
+/*
+ * Advance the shift register of one UART by one microsecond
+ */
+static void uartTick(int uart) {
+    dmxUartModel *u = &dmxUartHost[uart];
+    if (bitUs[uart] == 0) {
+        if ((u->shiftBits == 0) && (u->count > 0) && !u->brk) {
+            // start bit 0, 8 data bits LSB first, 2 stop bits 1
+            u->shift = ((uint16_t)u->fifo[u->head] << 1) | 0x600;
+            u->shiftBits = 11;
+            u->head = (u->head + 1) % DMX_UART_FIFO_SIZE;
+            u->count--;
+            if (uartIsr && dmxUartTxIntPending(uart)) uartIsr(uartArg);
+        }
+        if (u->shiftBits > 0) {
+            u->level = u->shift & 1;
+            u->shift >>= 1;
+            u->shiftBits--;
+            bitUs[uart] = DMX_BIT_US;
+        } else {
+            u->level = 1;
+        }
+    }
+    if (bitUs[uart] > 0) bitUs[uart]--;
+}
+
+void dmxHostRun(uint32_t us) {
+    for (uint32_t i = 0; i < us; i++) {
+        if (timerArmed && (dmxHostNow >= timerDue)) {
+            timerArmed = false;
+            if (timerIsr) timerIsr();
+        }
+        for (int u = 0; u < 2; u++) uartTick(u);
+
+        uint8_t level = dmxUartHost[1].brk ? 0 : dmxUartHost[1].level;
+        if ((level != lineLevel) && (dmxHostLineLen < DMX_HOST_EVENTS)) {
+            dmxHostLine[dmxHostLineLen].t = dmxHostNow;
+            dmxHostLine[dmxHostLineLen].level = level;
+            dmxHostLineLen++;
+        }
+        lineLevel = level;
+        if (((dmxHostNow % DMX_I2S_WORD_US) == 0) && (dmxHostI2sQueued > 0)) dmxHostI2sQueued--;
+        dmxHostNow++;
+    }
+}
+
+#endif // ARDUINO
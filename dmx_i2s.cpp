@@ -0,0 +1,150 @@
+/*
+ * DMX512 output over I2S
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "dmx_i2s.h"
+#include "dmx_hw.h"
+#include "send_break.h"
+
+/*
+ * Append count bits of level to the bitstream, words go out MSB first
+ */
+static uint32_t putBits(uint32_t *words, uint32_t bit, uint32_t maxBits, uint8_t level, uint16_t count) {
+    for (uint16_t i = 0; (i < count) && (bit < maxBits); i++, bit++) {
+        if (level) words[bit >> 5] |= 0x80000000UL >> (bit & 31);
+    }
+    return bit;
+}
+
+/*
+ * Encode a DMX frame into I2S words
+ * Break and MAB are rounded up to whole bits of 4us, the last word is
+ * padded with mark. Returns the number of words used.
+ */
+uint16_t dmxI2sEncode(const uint8_t *data, uint16_t length, uint16_t breakus, uint16_t mabus, uint32_t *words, uint16_t maxWords) {
+    uint32_t maxBits = (uint32_t)maxWords * 32;
+    uint32_t bit = 0;
+
+    memset(words, 0, maxWords * sizeof(uint32_t));
+    bit = putBits(words, bit, maxBits, 0, (breakus + DMX_BIT_US - 1) / DMX_BIT_US);
+    bit = putBits(words, bit, maxBits, 1, (mabus + DMX_BIT_US - 1) / DMX_BIT_US);
+    for (int32_t s = -1; s < length; s++) {
+        uint8_t b = (s < 0) ? 0 : data[s];   // start code first
+        bit = putBits(words, bit, maxBits, 0, 1);
+        for (int i = 0; i < 8; i++) {
+            bit = putBits(words, bit, maxBits, (b >> i) & 1, 1);
+        }
+        bit = putBits(words, bit, maxBits, 1, 2);
+    }
+    uint16_t used = (bit + 31) / 32;
+    putBits(words, bit, maxBits, 1, used * 32 - bit);
+    return used;
+}
+
+#ifndef ARDUINO
+/*
+ * Decode a bitstream from dmxI2sEncode() back into slots, start code first
+ * Returns the number of slots or -1 if there is no valid break/MAB
+ * or a slot has a framing error
+ */
+int dmxI2sDecode(const uint32_t *words, uint16_t numWords, uint8_t *slots, uint16_t maxSlots) {
+    uint32_t bits = (uint32_t)numWords * 32;
+    uint32_t bit = 0;
+    #define LEVEL(n) ((words[(n) >> 5] >> (31 - ((n) & 31))) & 1)
+
+    uint32_t low = 0;
+    while ((bit < bits) && !LEVEL(bit)) { bit++; low++; }
+    if (low * DMX_BIT_US < DMX_BREAK) return -1;
+    uint32_t high = 0;
+    while ((bit < bits) && LEVEL(bit)) { bit++; high++; }
+    if (high * DMX_BIT_US < DMX_MAB) return -1;
+
+    int n = 0;
+    while ((bit + 11 <= bits) && (n < maxSlots)) {
+        if (LEVEL(bit)) break;   // no start bit, frame is over
+        uint8_t b = 0;
+        for (int i = 0; i < 8; i++) b |= LEVEL(bit + 1 + i) << i;
+        if (!LEVEL(bit + 9) || !LEVEL(bit + 10)) return -1;
+        slots[n++] = b;
+        bit += 11;
+    }
+    #undef LEVEL
+    return n;
+}
+#endif
+
+dmxI2sOutput::dmxI2sOutput() {
+    this->numWords = 0;
+    this->pos = 0;
+    this->wordsSinceStart = 0;
+    this->wordsPerPeriod = 0;
+    this->source = NULL;
+    this->channels = FRAME_SIZE;
+    this->run_on = false;
+    this->frameCount = 0;
+}
+
+/*
+ * Start the I2S DMA, uartPin is the UART1 TX pin to give back to the UART
+ */
+void dmxI2sOutput::begin(int uartPin) {
+    dmxI2sBegin(uartPin);
+    this->handle();
+}
+
+/*
+ * Send frames from the latest complete frame of frames every period microseconds
+ */
+void dmxI2sOutput::run(frameBuffer *frames, uint32_t period, uint16_t channels) {
+    this->source = frames;
+    this->channels = channels;
+    this->wordsPerPeriod = period / DMX_I2S_WORD_US;
+    this->run_on = true;
+}
+
+void dmxI2sOutput::stop() {
+    this->run_on = false;
+}
+
+bool dmxI2sOutput::running() {
+    return this->run_on;
+}
+
+/*
+ * Start the next frame as soon as the current one is out, for ArtSync
+ * It reaches the line after the words already queued for DMA, at most
+ * DMX_I2S_LOOKAHEAD
+ */
+void dmxI2sOutput::sync() {
+    this->wordsSinceStart = this->wordsPerPeriod;
+}
+
+/*
+ * Keep the DMA ring fed up to DMX_I2S_LOOKAHEAD words, call from loop()
+ * Between frames the line is held at mark, a new frame starts once
+ * a period worth of words has gone out since the last frame start.
+ */
+void dmxI2sOutput::handle() {
+    while (!dmxI2sFull() && (dmxI2sQueued() < DMX_I2S_LOOKAHEAD)) {
+        if (this->pos < this->numWords) {
+            dmxI2sWrite(this->words[this->pos++]);
+        } else if (this->run_on && (this->wordsSinceStart >= this->wordsPerPeriod)) {
+            globalStruct *frame = this->source->acquire();
+            uint16_t length = (frame->length < this->channels) ? frame->length : this->channels;
+            this->numWords = dmxI2sEncode(frame->data, length, breakTime(), mabTime(), this->words, DMX_I2S_FRAME_WORDS);
+            this->pos = 0;
+            this->wordsSinceStart = 0;
+            this->frameCount++;
+            continue;
+        } else {
+            dmxI2sWrite(DMX_I2S_IDLE);
+        }
+        this->wordsSinceStart++;
+    }
+}
+
+uint32_t dmxI2sOutput::frames() {
+    return this->frameCount;
+}
@@ -0,0 +1,56 @@
+/*
+ * DMX512 output over I2S
+ *
+ * A second DMX port without a second free UART: the whole frame, break and
+ * MAB included, is encoded as a bitstream at 250000 bit/s and clocked out of
+ * the I2S data pin (GPIO3) by DMA. Frame timing is counted in I2S words, so
+ * it is exact on the wire as long as loop() keeps the DMA ring fed.
+ *
+ * The ring could hold ~65ms, it is only filled DMX_I2S_LOOKAHEAD words
+ * ahead of the line. A frame started by ArtSync has to wait for what is
+ * queued, so this bounds the sync delay of the port to the rest of the
+ * current frame plus ~25ms. handle() must run well within that time.
+ */
+
+#ifndef _DMX_I2S_H_
+#define _DMX_I2S_H_
+
+#include <stdint.h>
+#include "dmx_frames.h"
+#include "send_break.h"
+
+// longest break + MAB + 513 slots of 11 bits, rounded up to whole words
+#define DMX_I2S_FRAME_WORDS ((2 * DMX_BREAK_MAX / 4 + 513 * 11 + 31) / 32)
+#define DMX_I2S_IDLE 0xffffffff   // mark, line idle high
+#define DMX_I2S_LOOKAHEAD 192     // words queued ahead of the line, ~25ms
+
+uint16_t dmxI2sEncode(const uint8_t *data, uint16_t length, uint16_t breakus, uint16_t mabus, uint32_t *words, uint16_t maxWords);
+#ifndef ARDUINO
+int dmxI2sDecode(const uint32_t *words, uint16_t numWords, uint8_t *slots, uint16_t maxSlots);
+#endif
+
+class dmxI2sOutput {
+    public:
+        dmxI2sOutput();
+
+        void begin(int uartPin);
+        void run(frameBuffer *frames, uint32_t period, uint16_t channels);
+        void stop();
+        bool running();
+        void sync();
+        void handle();
+        uint32_t frames();
+
+    private:
+        uint32_t words[DMX_I2S_FRAME_WORDS];   // encoded frame
+        uint16_t numWords;
+        uint16_t pos;                          // next word to go to the DMA ring
+        uint32_t wordsSinceStart;              // words written since the last frame start
+        uint32_t wordsPerPeriod;
+        frameBuffer *source;
+        uint16_t channels;
+        bool run_on;
+        uint32_t frameCount;
+};
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ * Merging of two sources sending the same universe
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dmx_merge.h"
+#include "dmx_frames.h"
+
+#define BYTE_HIGH 0x80808080UL
+#define BYTE_LOW  0x7f7f7f7fUL
+
+/*
+ * Per byte maximum of four channels in a word
+ * ge gets the high bit of every byte where a >= b, it is then widened to a
+ * byte mask: 0x80 -> 0xff
+ */
+static inline uint32_t max4(uint32_t a, uint32_t b) {
+    uint32_t low = (a | BYTE_HIGH) - (b & ~BYTE_HIGH);   // no borrow between bytes
+    uint32_t ge = ((a & ~b) | (~(a ^ b) & low)) & BYTE_HIGH;
+    uint32_t m = (ge << 1) - (ge >> 7);
+    return (a & m) | (b & ~m);
+}
+
+/*
+ * HTP merge of length channels, the buffers are FRAME_SIZE bytes, word aligned
+ */
+void mergeHtp(uint8_t *out, const uint8_t *a, const uint8_t *b, uint16_t length) {
+    uint32_t *o = (uint32_t *)out;
+    const uint32_t *wa = (const uint32_t *)a;
+    const uint32_t *wb = (const uint32_t *)b;
+    for (int i = 0; i < (length + 3) / 4; i++) o[i] = max4(wa[i], wb[i]);
+}
+
+/*
+ * Byte mask of the channels that differ between two words, 0xff for each
+ * byte that is not 0 in a ^ b
+ */
+static inline uint32_t changed4(uint32_t a, uint32_t b) {
+    uint32_t d = a ^ b;
+    uint32_t nz = (((d & BYTE_LOW) + BYTE_LOW) | d) & BYTE_HIGH;   // no carry between bytes
+    return (nz << 1) - (nz >> 7);
+}
+
+/*
+ * LTP merge of length channels, the buffers are FRAME_SIZE bytes, word aligned
+ * A channel where next differs from prev, the previous frame of the same
+ * source, takes the value of next, the others keep current. out may be next.
+ */
+void mergeLtp(uint8_t *out, const uint8_t *current, const uint8_t *prev, const uint8_t *next, uint16_t length) {
+    uint32_t *o = (uint32_t *)out;
+    const uint32_t *wc = (const uint32_t *)current;
+    const uint32_t *wp = (const uint32_t *)prev;
+    const uint32_t *wn = (const uint32_t *)next;
+    for (int i = 0; i < (length + 3) / 4; i++) {
+        uint32_t m = changed4(wp[i], wn[i]);
+        o[i] = (wn[i] & m) | (wc[i] & ~m);
+    }
+}
+
+dmxMerge::dmxMerge() {
+    memset(this->source, 0, sizeof(this->source));
+    this->mergeMode = MERGE_HTP;
+}
+
+void dmxMerge::setMode(int mode) {
+    this->mergeMode = (mode == MERGE_LTP) ? MERGE_LTP : MERGE_HTP;
+}
+
+int dmxMerge::mode() {
+    return this->mergeMode;
+}
+
+/*
+ * Drop sources that timed out, returns the number left
+ */
+int dmxMerge::active(uint32_t now) {
+    int n = 0;
+    for (int i = 0; i < MERGE_SOURCES; i++) {
+        mergeSource *s = &this->source[i];
+        if ((s->ip != 0) && ((now - s->lastSeen) > MERGE_TIMEOUT)) {
+            s->ip = 0;
+            s->stored = false;
+        }
+        if (s->ip != 0) n++;
+    }
+    return n;
+}
+
+/*
+ * Keep the frame of source s, the buffer is allocated on first use
+ * The rest of the buffer is cleared so shorter frames merge as zero
+ */
+bool dmxMerge::store(mergeSource *s, const uint8_t *data, uint16_t length) {
+    if (s->data == NULL) {
+        s->data = (uint8_t *)malloc(FRAME_SIZE);
+        if (s->data == NULL) return false;
+    }
+    if (length > FRAME_SIZE) length = FRAME_SIZE;
+    memcpy(s->data, data, length);
+    memset(s->data + length, 0, FRAME_SIZE - length);
+    s->length = length;
+    s->stored = true;
+    return true;
+}
+
+/*
+ * Take a frame of universe from ip, now in ms
+ * A sender is the pair of both, one console with two universes on a port
+ * is two sources
+ * current is the frame on the output, it is the last frame of the other
+ * source when merging starts and the base LTP changes channels in. The
+ * merged frame goes to out, FRAME_SIZE bytes and word aligned, current
+ * is word aligned as well. The first frame of a new source takes all of
+ * its channels in LTP mode.
+ */
+int dmxMerge::update(uint32_t ip, uint16_t universe, const uint8_t *data, uint16_t length, const uint8_t *current, uint16_t currentLength,
+                     uint8_t *out, uint16_t *outLength, uint32_t now) {
+    mergeSource *self = NULL;
+    mergeSource *other = NULL;
+
+    this->active(now);
+    for (int i = 0; i < MERGE_SOURCES; i++) {
+        if ((this->source[i].ip == ip) && (this->source[i].universe == universe)) self = &this->source[i];
+    }
+    if (self == NULL) {
+        for (int i = 0; i < MERGE_SOURCES; i++) {
+            if (this->source[i].ip == 0) {
+                self = &this->source[i];
+                break;
+            }
+        }
+        if (self == NULL) return MERGE_IGNORED;
+        self->ip = ip;
+        self->universe = universe;
+        self->stored = false;
+    }
+    self->lastSeen = now;
+    for (int i = 0; i < MERGE_SOURCES; i++) {
+        if ((&this->source[i] != self) && (this->source[i].ip != 0)) other = &this->source[i];
+    }
+
+    if (other == NULL) {
+        self->stored = false;
+        return MERGE_SINGLE;
+    }
+    if (!other->stored && !this->store(other, current, currentLength)) return MERGE_SINGLE;
+
+    if (this->mergeMode == MERGE_LTP) {
+        // the new frame goes to out first, the previous one is still in self->data
+        uint16_t n = (length > FRAME_SIZE) ? FRAME_SIZE : length;
+        if (self->stored) {
+            memcpy(out, data, n);
+            memset(out + n, 0, FRAME_SIZE - n);
+            mergeLtp(out, current, self->data, out, FRAME_SIZE);
+        } else {
+            memcpy(out, current, FRAME_SIZE);
+            memcpy(out, data, n);
+        }
+        if (!this->store(self, data, length)) return MERGE_SINGLE;
+    } else {
+        if (!this->store(self, data, length)) return MERGE_SINGLE;
+        mergeHtp(out, self->data, other->data, FRAME_SIZE);
+    }
+    *outLength = (self->length > other->length) ? self->length : other->length;
+    return MERGE_MERGED;
+}
+
+/*
+ * Whether two sources are being merged
+ */
+bool dmxMerge::merging(uint32_t now) {
+    return this->active(now) > 1;
+}
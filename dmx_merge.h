@@ -0,0 +1,58 @@
+/*
+ * Merging of two sources sending the same universe
+ *
+ * With a single source its frames go to the output unchanged. As soon as a
+ * second sender (by IP address and universe) shows up, the last frame of each source is
+ * kept and the output is computed from both: HTP takes the higher value of
+ * every channel, LTP gives every channel the value of the source that last
+ * changed it. Channels are processed four at a time in 32 bit words. A source that stops sending is dropped after
+ * MERGE_TIMEOUT and the output falls back to the remaining one.
+ */
+
+#ifndef _DMX_MERGE_H_
+#define _DMX_MERGE_H_
+
+#include <stdint.h>
+
+#define MERGE_SOURCES 2        // Art-Net merges two sources, more are ignored
+#define MERGE_TIMEOUT 10000    // ms
+
+#define MERGE_HTP 0
+#define MERGE_LTP 1
+
+// result of dmxMerge::update()
+#define MERGE_SINGLE  0        // one source, use its frame as is
+#define MERGE_MERGED  1        // merged frame written to the output
+#define MERGE_IGNORED 2        // third source, frame not used
+
+struct mergeSource {
+    uint32_t ip;           // 0 for a free entry
+    uint16_t universe;
+    uint32_t lastSeen;
+    uint16_t length;
+    bool stored;           // frame kept in data
+    uint8_t *data;
+};
+
+void mergeHtp(uint8_t *out, const uint8_t *a, const uint8_t *b, uint16_t length);
+void mergeLtp(uint8_t *out, const uint8_t *current, const uint8_t *prev, const uint8_t *next, uint16_t length);
+
+class dmxMerge {
+    public:
+        dmxMerge();
+
+        void setMode(int mode);
+        int mode();
+        int update(uint32_t ip, uint16_t universe, const uint8_t *data, uint16_t length, const uint8_t *current, uint16_t currentLength,
+                   uint8_t *out, uint16_t *outLength, uint32_t now);
+        bool merging(uint32_t now);
+
+    private:
+        mergeSource source[MERGE_SOURCES];
+        int mergeMode;
+
+        int active(uint32_t now);
+        bool store(mergeSource *s, const uint8_t *data, uint16_t length);
+};
+
+#endif
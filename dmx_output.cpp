@@ -0,0 +1,297 @@
+/*
+ * Non-blocking DMX512 output
+ */
+
+#include <stddef.h>
+#include "dmx_output.h"
+#include "dmx_hw.h"
+#include "send_break.h"
+
+// Outputs by UART number, used by the shared UART interrupt handler
+static dmxOutput *dmxOutputs[2] = { NULL, NULL };
+
+// Output owning timer1 for break and MAB timing
+static dmxOutput *dmxTimerOutput = NULL;
+
+/*
+ * UART interrupt handler
+ * UART0 and UART1 share the interrupt, serve whichever output needs data
+ */
+static void ICACHE_RAM_ATTR dmxUartIsr(void *) {
+    for (int u = 0; u < 2; u++) {
+        if (dmxOutputs[u] && dmxUartTxIntPending(u)) {
+            dmxOutputs[u]->fill();
+        } else {
+            dmxUartIntClear(u);
+        }
+    }
+}
+
+/*
+ * timer1 interrupt handler
+ */
+static void ICACHE_RAM_ATTR dmxTimerIsr() {
+    if (dmxTimerOutput) dmxTimerOutput->tick();
+}
+
+dmxOutput::dmxOutput(int uart) {
+    this->uart = uart;
+    this->status = DMX_STATE_IDLE;
+    this->data = NULL;
+    this->length = 0;
+    this->pos = 0;
+    this->frames = NULL;
+    this->run_on = false;
+    this->period = 0;
+    this->channels = DMX_SLOTS;
+    this->shortFrames = false;
+    this->nextStart = 0;
+    this->lastStart = 0;
+    this->stat.frames = 0;
+    this->resetStats();
+}
+
+/*
+ * Hook the output into the UART interrupt
+ * The UART must already be set up for 250000 baud 8N2
+ */
+void dmxOutput::begin() {
+    dmxOutputs[this->uart] = this;
+    dmxTimerOutput = this;
+    dmxUartTxIntDisable(this->uart);
+    dmxUartAttach(dmxUartIsr, NULL);
+    dmxTimerAttach(dmxTimerIsr);
+}
+
+/*
+ * Send a single frame of length channels
+ * Returns false without doing anything if the previous frame is still going out
+ * or the scheduler is running
+ */
+bool dmxOutput::send(const uint8_t *data, uint16_t length) {
+    if (this->busy() || this->run_on) return false;
+    this->start(data, length);
+    return true;
+}
+
+/*
+ * Send frames from the latest complete frame of frames every period microseconds
+ * Calling it again with the same values changes nothing, so it can be called from loop()
+ */
+void dmxOutput::run(frameBuffer *frames, uint32_t period, uint16_t channels) {
+    this->frames = frames;
+    this->channels = channels;
+    if (this->run_on && (period == this->period)) return;
+
+    this->period = period;
+    this->resetStats();
+    if (!this->run_on) {
+        this->nextStart = dmxMicros() + DMX_SCHEDULE_MIN;
+        this->run_on = true;
+        // a frame still going out will schedule the next one when done
+        if (!this->busy()) dmxTimerArm(DMX_SCHEDULE_MIN);
+    }
+}
+
+/*
+ * Send only the used channels, as fast as the break-to-break time allows
+ */
+void dmxOutput::setShortFrames(bool on) {
+    if (on != this->shortFrames) this->resetStats();
+    this->shortFrames = on;
+}
+
+/*
+ * Start the next frame now instead of at the next period, for ArtSync
+ * A frame still going out is completed first
+ */
+void dmxOutput::sync() {
+    if (!this->run_on) return;
+    uint32_t savedPS = dmxIntLock();
+    if (this->busy()) {
+        this->nextStart = this->lastStart + this->frameTime(this->stat.lastLength);
+    } else {
+        this->nextStart = dmxMicros() + DMX_SCHEDULE_MIN;
+        dmxTimerArm(DMX_SCHEDULE_MIN);
+    }
+    dmxIntUnlock(savedPS);
+}
+
+/*
+ * Stop the scheduler, a frame going out is completed
+ */
+void dmxOutput::stop() {
+    this->run_on = false;
+}
+
+bool dmxOutput::running() {
+    return this->run_on;
+}
+
+/*
+ * Start a frame, break and MAB are timed by timer1
+ */
+void ICACHE_RAM_ATTR dmxOutput::start(const uint8_t *data, uint16_t length) {
+    if (length > DMX_SLOTS) length = DMX_SLOTS;
+    this->stat.frames++;
+
+    this->data = data;
+    this->length = length + 1;
+    this->pos = 0;
+
+    // the rest of the frame is driven by timer1 and the FIFO interrupt
+    this->status = DMX_STATE_BREAK;
+    breakStart(this->uart);
+    dmxTimerArm(breakTime());
+}
+
+/*
+ * Scheduled start of a frame from the timer interrupt
+ * Takes the latest complete frame and records how far off schedule we are
+ */
+void ICACHE_RAM_ATTR dmxOutput::frameStart() {
+    uint32_t now = dmxMicros();
+    int32_t jitter = (int32_t)(now - this->nextStart);
+
+    if (this->stat.scheduled > 0) {
+        this->stat.lastPeriod = now - this->lastStart;
+        if (jitter < this->stat.jitterMin) this->stat.jitterMin = jitter;
+        if (jitter > this->stat.jitterMax) this->stat.jitterMax = jitter;
+        this->stat.jitterSum += (jitter < 0) ? -jitter : jitter;
+    }
+    this->stat.scheduled++;
+    this->lastStart = now;
+
+    globalStruct *frame = this->frames->acquire();
+    uint16_t length = (frame->length < this->channels) ? frame->length : this->channels;
+    if (this->shortFrames) {
+        // trim to the used channels, the next break follows right after the frame
+        uint16_t used = this->frames->used();
+        if (used < length) length = used;
+        uint32_t t = this->frameTime(length);
+        this->nextStart = now + ((t > DMX_MIN_BREAK_TO_BREAK) ? t : DMX_MIN_BREAK_TO_BREAK);
+    } else {
+        this->nextStart += this->period;
+    }
+    this->stat.lastLength = length;
+    this->start(frame->data, length);
+}
+
+/*
+ * Time on the wire for a frame of length channels, including the wait
+ * for the last slot to leave the shift register
+ */
+uint32_t ICACHE_RAM_ATTR dmxOutput::frameTime(uint16_t length) {
+    return breakTime() + mabTime() + (length + 2) * DMX_SLOT_US + DMX_SCHEDULE_MIN;
+}
+
+/*
+ * Arm timer1 for the next frame start, called when a frame is done
+ * If the frame took longer than the period, the schedule restarts from now
+ */
+void ICACHE_RAM_ATTR dmxOutput::schedule() {
+    int32_t wait = (int32_t)(this->nextStart - dmxMicros());
+    if (wait < DMX_SCHEDULE_MIN) {
+        if (wait < 0) {
+            this->stat.overruns++;
+            this->nextStart = dmxMicros() + DMX_SCHEDULE_MIN;
+        }
+        wait = DMX_SCHEDULE_MIN;
+    }
+    dmxTimerArm(wait);
+}
+
+/*
+ * Step through break and MAB, called from the timer1 interrupt
+ * After the FIFO ran empty the timer waits one slot time
+ * for the last byte to leave the shift register.
+ * When running, the next frame is scheduled once a frame is done.
+ */
+void ICACHE_RAM_ATTR dmxOutput::tick() {
+    switch (this->status) {
+        case DMX_STATE_IDLE:
+        case DMX_STATE_DONE:
+            if (this->run_on) this->frameStart();
+            break;
+        case DMX_STATE_BREAK:
+            breakEnd(this->uart);
+            this->status = DMX_STATE_MAB;
+            dmxTimerArm(mabTime());
+            break;
+        case DMX_STATE_MAB:
+            this->status = DMX_STATE_DATA;
+            this->fill();
+            break;
+        case DMX_STATE_DATA:
+            if (this->pos >= this->length) {
+                this->status = DMX_STATE_DONE;
+                if (this->run_on) this->schedule();
+            }
+            break;
+    }
+}
+
+/*
+ * Top up the FIFO, called after the MAB and from the FIFO-empty interrupt
+ * Once everything is queued the threshold drops to 1 so the last
+ * interrupt comes when the FIFO has drained completely.
+ */
+void ICACHE_RAM_ATTR dmxOutput::fill() {
+    if (this->status != DMX_STATE_DATA) {
+        dmxUartTxIntDisable(this->uart);
+        return;
+    }
+    if (this->pos < this->length) {
+        if (this->pos == 0) {
+            dmxUartWrite(this->uart, 0);   // start code
+            this->pos++;
+        }
+        while ((this->pos < this->length) && (dmxUartTxCount(this->uart) < DMX_UART_FIFO_SIZE)) {
+            dmxUartWrite(this->uart, this->data[this->pos-1]);
+            this->pos++;
+        }
+        dmxUartTxIntEnable(this->uart, (this->pos < this->length) ? DMX_FIFO_LOW : 1);
+    } else if (dmxUartTxCount(this->uart) == 0) {
+        dmxUartTxIntDisable(this->uart);
+        dmxTimerArm(DMX_SLOT_US);
+    } else {
+        dmxUartTxIntEnable(this->uart, 1);
+    }
+}
+
+dmxFrameStats dmxOutput::stats() {
+    dmxFrameStats s = this->stat;
+    s.period = this->period;
+    return s;
+}
+
+void dmxOutput::resetStats() {
+    this->stat.scheduled = 0;
+    this->stat.overruns = 0;
+    this->stat.lastPeriod = 0;
+    this->stat.lastLength = 0;
+    this->stat.jitterMin = 0;
+    this->stat.jitterMax = 0;
+    this->stat.jitterSum = 0;
+}
+
+int dmxOutput::state() {
+    return this->status;
+}
+
+bool dmxOutput::busy() {
+    int s = this->status;
+    return (s == DMX_STATE_BREAK) || (s == DMX_STATE_MAB) || (s == DMX_STATE_DATA);
+}
+
+/*
+ * Wait until the current frame has gone out, like Serial.flush()
+ */
+void dmxOutput::flush() {
+    while (this->busy()) {
+#ifdef ARDUINO
+        yield();
+#endif
+    }
+}
+
@@ -0,0 +1,95 @@
+/*
+ * Non-blocking DMX512 output
+ *
+ * The frame is fed straight from the caller's buffer into the UART TX FIFO
+ * from the FIFO-empty interrupt, the buffer must stay untouched until the
+ * frame is done (see dmx_frames.h). Sending a frame returns immediately instead
+ * of blocking loop() for the ~23ms a full 512 channel frame takes on the wire.
+ * Break and MAB are timed with timer1, see send_break.cpp.
+ *
+ * With run() the output becomes free running: timer1 starts every frame at
+ * a fixed period from the latest complete frame of a frameBuffer, no matter
+ * what loop() is doing.
+ *
+ * In short frame mode only the channels up to the highest used one are sent
+ * and the frames follow each other as fast as the minimum break-to-break time
+ * allows, which gives refresh rates well above 100Hz for small rigs.
+ */
+
+#ifndef _DMX_OUTPUT_H_
+#define _DMX_OUTPUT_H_
+
+#include <stdint.h>
+#include "dmx_frames.h"
+
+// Output states
+#define DMX_STATE_IDLE  0     // no frame sent yet
+#define DMX_STATE_BREAK 1     // sending the break
+#define DMX_STATE_MAB   2     // mark after break
+#define DMX_STATE_DATA  3     // start code and slots are being fed into the FIFO
+#define DMX_STATE_DONE  4     // last slot has left the FIFO, ready for the next frame
+
+// Minimum time from break to break per E1.11, in microseconds
+#define DMX_MIN_BREAK_TO_BREAK 1204
+
+// Shortest wait armed on timer1, in microseconds
+#define DMX_SCHEDULE_MIN 10
+
+// FIFO refill threshold, leaves ~1.4ms of data in the FIFO when the interrupt fires
+#define DMX_FIFO_LOW 32
+
+// Frame timing statistics of the scheduler, times in microseconds
+struct dmxFrameStats {
+    uint32_t frames;        // frames started, scheduled or single
+    uint32_t scheduled;     // frames started by the scheduler
+    uint32_t overruns;      // frames started late because the previous one was still going
+    uint32_t period;        // configured period
+    uint32_t lastPeriod;    // measured time between the last two frame starts
+    uint16_t lastLength;    // channels in the last frame
+    int32_t  jitterMin;     // deviation of the frame start from the schedule
+    int32_t  jitterMax;
+    uint32_t jitterSum;     // sum of the absolute deviations, for the average
+};
+
+class dmxOutput {
+    public:
+        dmxOutput(int uart);
+
+        void begin();
+        bool send(const uint8_t *data, uint16_t length);
+        void run(frameBuffer *frames, uint32_t period, uint16_t channels);
+        void setShortFrames(bool on);
+        void sync();
+        void stop();
+        bool running();
+        dmxFrameStats stats();
+        void resetStats();
+        int  state();
+        bool busy();
+        void flush();
+        void fill();
+        void tick();
+
+    private:
+        void start(const uint8_t *data, uint16_t length);
+        void frameStart();
+        void schedule();
+        uint32_t frameTime(uint16_t length);
+
+        int uart;
+        volatile int status;
+        const uint8_t *data;          // slots of the frame being sent
+        uint16_t length;              // bytes in frame including the start code
+        volatile uint16_t pos;        // next byte to go into the FIFO
+
+        frameBuffer *frames;          // source of the frames when running
+        volatile bool run_on;
+        volatile uint32_t period;
+        volatile uint16_t channels;
+        volatile bool shortFrames;
+        uint32_t nextStart;           // scheduled start of the next frame
+        uint32_t lastStart;
+        dmxFrameStats stat;
+};
+
+#endif
@@ -5,24 +5,27 @@
 #ifndef ESP_DMX_H
 #define ESP_DMX_H
 
-// Global universe buffer
-struct globalStruct {
-    uint16_t universe;
-    uint16_t length;
-    uint8_t sequence;
-    uint8_t *data;
-} ;
+#define DMX_PORTS 2   // UART1 and I2S
+
+#include "universe_frame.h"
 
 // Structure for configurable values
 struct Config {
   String hostname;
   String fwURL;
   int universe;
+  int universe2;
+  String routes;      // additional Port-Address routes, see route_table.h
+  int ports;
   int channels;
   int delay;
   int holdsecs;
   int pOnShowCh1;
   int pOnShowNumCh;
+  int breakus;
+  int mabus;
+  int shortFrames;
+  int mergeMode;      // MERGE_HTP or MERGE_LTP
 };
 
 #endif
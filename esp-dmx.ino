@@ -15,17 +15,31 @@
 #include <WiFiManager.h>          // https://github.com/tzapu/WiFiManager
 #include <ESP8266mDNS.h>          // For zeroconf
 #include <WiFiClient.h>
-#include <ArtnetnodeWifi.h>       // https://github.com/rstephan/ArtnetnodeWifi
 #include <Adafruit_NeoPixel.h>    // Driver for the WS2812 color LED
 //#define REMOTEDEBUG
 #ifdef REMOTEDEBUG
 #include "RemoteDebug.h"          // https://github.com/JoaoLopesF/RemoteDebug
 #endif
 #include <FS.h>
+#include <coredecls.h>           // esp_delay(), ESP8266 core 3.0 or later
 #include "webui.h"
+#include "dmx_output.h"
+#include "dmx_i2s.h"
 #include "send_break.h"
 #include "statusLED.h"
 #include "esp-dmx.h"
+#include "dmx_frames.h"
+#include "artnet_ring.h"
+#include "artnet_udp.h"
+#include "route_table.h"
+#include "sacn.h"
+#include "dmx_merge.h"
+#include "artnet_sync.h"
+#include "artnet_seq.h"
+#include "source_stats.h"
+#include "artnet_pollreply.h"
+#include "task_scheduler.h"
+#include "loop_profile.h"
 
 #define MIN(a,b) ({ __typeof__ (a) _a = (a); __typeof__ (b) _b = (b); _a < _b ? _a : _b; })
 #define MAX(a,b) ({ __typeof__ (a) _a = (a); __typeof__ (b) _b = (b); _a > _b ? _a : _b; })
@@ -40,8 +54,8 @@
 // Struct for configurable values
 struct Config config;
 
-// Global universe buffer
-struct globalStruct global;
+// Global universe buffers, triple buffered, one per output port
+frameBuffer global[DMX_PORTS];
 
 ESP8266WebServer webServer(80);
 
@@ -60,13 +74,31 @@ int version_mayor = 1;
 int version_minor = 4;
 
 // Artnet settings
-ArtnetnodeWifi artnetnode;
+artnetUdp artnetnode;
+artnetRing artnetQueue;     // received frames waiting to be committed to the ports
+routeTable routes;          // Port-Addresses wanted by the ports
+sacnReceiver sacn;          // sACN (E1.31) feeding the same receive ring
+dmxMerge merge[DMX_PORTS];  // merging of two senders per port
+artnetSync artsync;         // frames held back for ArtSync
+seqTracker sequence;        // loss, reorder and duplicate counts per universe and sender
+sourceStats senders;        // packet statistics of everybody sending DMX to us
+artnetPollReply pollReply;  // our answer to ArtPoll
+uint32_t schedulerClock() { return millis(); }
+taskScheduler scheduler(schedulerClock);   // runs everything loop() does
+#ifdef LOOP_PROFILE
+loopProfile profile;        // cycles spent per stage of setup() and loop()
+#endif
 
 // counters to keep track of things, display statistics
 unsigned long packetCounter = 0;
 unsigned long dmxFrameCounter = 0;
+unsigned long dmxFps[2] = { 0, 0 };   // achieved frames/s with full and short frames
+unsigned long dmxFpsFrames = 0;
 unsigned long dmxUMatchCounter = 0;
 unsigned long artnetPacketCounter = 0;
+unsigned long artnetAccepted = 0;    // frames queued for a port
+unsigned long artnetCoalesced = 0;   // frames replaced by a newer one of the same universe
+unsigned long artnetDropped = 0;     // frames lost, receive ring full
 bool packetReceived = false;    // Artnet packet in buffer waiting to be sent as DMX, gets reset after sending DMX
 unsigned long holdframe = 0;    // holding last valid frame for some time
 unsigned long debugval = 0;
@@ -79,9 +111,10 @@ long millis_serialstatus=0;     // timestamp for periodical status on serial por
 long millis_dmxsend = 0;        // timestamp for limiting the dmx transmit rate
 long millis_statusled = 0;      // for status led change
 long millis_checkversion = 0;   // timestamp to check for new version
-long dmxskip = 0;       // counter for artnet frames not sent as DMX
+long dmxskip = 0;       // counter for DMX frames started late, previous frame still going
 long millis_analogread = 0;
-long dmxloop;
+long millis_dmxfps = 0;         // timestamp for the frame rate measurement
+long dmxloop;          // measured DMX frame period in us
 long micros_dmxsend = 0;
 uint16_t seen_universe = 0;  // universe number of last seen artnet frame
 int last_rssi;               // Wifi RSSI for display
@@ -89,8 +122,7 @@ int last_rssi;               // Wifi RSSI for display
 int temperature = 0;  // temperature in deg c
 int tempAdc = 0;      // temperature reading from ADC
 
-//#define VERSIONCHECKINTERVAL (3600 * 24 * 7 * 1000)   // Check for new version once a week
-#define VERSIONCHECKINTERVAL 10000
+#define VERSIONCHECKINTERVAL (3600UL * 24 * 7 * 1000)   // Check for new version once a week, the connect blocks, see version_check.h
 
 int fanspeed = 0;     // speed of the fan
 
@@ -110,6 +142,8 @@ char * status_text[] = { "", "Booting", "Config not found", "Config found", "Ini
 
 #define PIN_DMX_OUT    2  // gpio2/D4
 #define PIN_DMX_ENABLE 5  // gpio5/D1
+#define PIN_DMX2_OUT    3 // gpio3/RX, I2S data
+#define PIN_DMX2_ENABLE 4 // gpio4/D2
 #define PIN_ANALOG A0     // A0
 #define PIN_FAN 16        // GPIO16/D0
 
@@ -119,6 +153,14 @@ Adafruit_NeoPixel neoPixel = Adafruit_NeoPixel(1, PIN_NEOPIXEL, NEO_GRB);
 
 statusLED LED = statusLED(neoPixel);
 
+// DMX output on UART1
+#define DMX_UART 1
+dmxOutput dmx = dmxOutput(DMX_UART);
+
+// Second DMX output through I2S
+dmxI2sOutput dmx2;
+int dmxPorts = 1;   // output ports in use, config.ports takes effect at boot
+
 /*
  * Temperature measurements
  */
@@ -208,59 +250,223 @@ void fanControl () {
 
 
 /*
- * Send DMX data from buffer out through serial port 1
+ * Send a single DMX frame from buffer out through serial port 1
+ * The frame is handed to the interrupt driven output, this returns immediately
  */
 void sendDmxData(int delay) {
-    dmxloop = millis() - millis_dmxsend;
-    if ((millis() - millis_dmxsend ) >= delay) {
+    if (((millis() - millis_dmxsend ) >= delay) && !dmx.busy()) {
         millis_dmxsend  = millis();
-        dmxFrameCounter++;
         micros_dmxsend = micros();
-        sendBreak();
-        Serial1.write(0); // Start-Byte
-        // send out the value of the selected channels (up to 512)
-        for (int i = 0; i < MIN(global.length, config.channels); i++) {
-            Serial1.write(global.data[i]);
-        }
+        // send out the value of the selected channels (up to 512) from the latest complete frame
+        globalStruct *frame = global[0].acquire();
+        dmx.send(frame->data, MIN(frame->length, config.channels));
         micros_dmxsend = micros()-micros_dmxsend;
-    } else {
-        dmxskip++;
     }
 }
 
+/*
+ * Keep the DMX output running at the configured frame rate
+ * Frames are started by timer1, independent of what loop() is doing
+ */
+void runDmxOutput() {
+    digitalWrite(PIN_DMX_ENABLE, HIGH);
+    dmx.setShortFrames(config.shortFrames);
+    dmx.run(&global[0], config.delay * 1000, config.channels);
+    if (dmxPorts > 1) {
+        digitalWrite(PIN_DMX2_ENABLE, HIGH);
+        dmx2.run(&global[1], config.delay * 1000, config.channels);
+    }
+}
+
+/*
+ * Stop the DMX output after the current frame and disable the driver
+ */
+void stopDmxOutput() {
+    dmx.stop();
+    dmx.flush();
+    digitalWrite(PIN_DMX_ENABLE, LOW);
+    dmx2.stop();
+    digitalWrite(PIN_DMX2_ENABLE, LOW);
+}
+
+/*
+ * Port-Address of an output port, its route from config.routes if it
+ * has one, else the universe configured for it
+ */
+int portUniverse(int port) {
+    int address = routes.portAddress(port);
+    if (address >= 0) return address;
+    return (port == 0) ? config.universe : config.universe2;
+}
+
+/*
+ * Set up the routing table from the configuration
+ * A port takes its route from config.routes, the others their universe
+ * Returns false if config.routes is not valid, it is ignored then
+ */
+bool buildRoutes() {
+    bool ok = true;
+
+    routes.clear();
+    if (routes.parse(config.routes.c_str(), dmxPorts) < 0) {
+        ok = false;
+        routes.clear();
+    }
+    // fails for a port that already has its route
+    for (int port = 0; port < dmxPorts; port++) routes.add(portUniverse(port), ROUTE_PORT(port));
+
+    // sACN universe 1 is Port-Address 0
+    sacn.clearUniverses();
+    for (int i = 0; i < routes.count(); i++) sacn.addUniverse(routes.addressAt(i) + 1);
+    return ok;
+}
+
 /*
  * Artnet packet routine
  * 
- * This routine is called for each received artnet packet
- * If the universe of the received packet matches the configured universe
- * we copy the dmx data to the dmx buffer
+ * This routine is called for each received artnet packet, from the network stack
+ * If the universe of the received packet is routed to a port and the frame
+ * is not older than the last one of the sender, the receiver copies the
+ * frame into the receive ring, a frame of the same universe still waiting
+ * there is replaced
  *
  */
-void onArtnetFrame(uint16_t universe, uint16_t length, uint8_t sequence, uint8_t * data) {
+bool onArtnetFrame(uint16_t universe, uint32_t source, uint8_t seq) {
     seen_universe = universe;
     artnetPacketCounter++;
     millis_artnetreceived = millis();
     
-    if (universe == config.universe) {
-        packetReceived = true;
-        // If the universe matches copy the data from the UDP packet over to the global universe buffer
-        millis_dmxready = millis();
-        dmxUMatchCounter++;
-        global.universe = universe;
-        global.sequence = sequence;
-        if (length < 512) global.length = length;
-        for (int i = 0; i < global.length; i++)
-            global.data[i] = data[i];
+    if (!routes.routed(universe)) return false;
+    if (sequence.check(universe, source, source, seq, true) != SEQ_NEW) return false;
+    if (sequence.gap()) senders.lost(source, universe, false, sequence.gap());
+    scheduler.wake();
+    return true;
+}
+
+/*
+ * sACN packet routine, like onArtnetFrame() for E1.31 data packets
+ * address is the Port-Address the sACN universe maps to, only the source
+ * with the highest priority gets here
+ */
+bool onSacnFrame(uint16_t address, uint32_t source, const uint8_t *cid, uint8_t seq) {
+    millis_artnetreceived = millis();
+    if (!routes.routed(address)) return false;
+    if (sequence.check(address, sacnCidKey(cid), source, seq, false) != SEQ_NEW) return false;
+    if (sequence.gap()) senders.lost(source, address, true, sequence.gap());
+    scheduler.wake();
+    return true;
+}
+
+/*
+ * Send the ArtPollReply when one is due, see artnet_pollreply.h
+ * Only the fields that change are brought up to date before sending
+ */
+void handleArtnetPoll() {
+    if (!pollReply.due(millis())) return;
+
+    uint16_t address[DMX_PORTS];
+    IPAddress ip = WiFi.localIP();
+    uint8_t ipBytes[4] = { ip[0], ip[1], ip[2], ip[3] };
+    pollReply.setIp(ipBytes);
+    pollReply.setName(config.hostname.c_str());
+    for (int port = 0; port < dmxPorts; port++) {
+        address[port] = portUniverse(port);
+        bool running = (port == 0) ? dmx.running() : dmx2.running();
+        uint8_t good = running ? 0x80 : 0x00;                 // data is transmitted
+        if (merge[port].merging(millis())) good |= 0x08;      // merging
+        if (merge[port].mode() == MERGE_LTP) good |= 0x02;
+        pollReply.setGoodOutput(port, good);
+    }
+    pollReply.setPorts(dmxPorts, address);
+    int replies = pollReply.replies();
+    for (int i = 0; i < replies; i++) {
+        artnetnode.send(pollReply.next(i), ARTNET_POLLREPLY_SIZE, (uint32_t)WiFi.broadcastIP());
+    }
+}
+
+/*
+ * ArtSync routine, called from the network stack
+ * ArtSync is ignored while merging and from another IP than the sender
+ * of the staged frames, as the spec requires
+ */
+void onArtnetSync(uint32_t addr) {
+    for (int port = 0; port < dmxPorts; port++) {
+        if (merge[port].merging(millis())) return;
+    }
+    if (artsync.received(millis(), addr)) scheduler.wake();
+}
+
+/*
+ * Commit the newest frame of each universe waiting in the receive ring to
+ * the ports it is routed to
+ *
+ * The frame of the last port with the universe is handed over by swapping
+ * the buffer with the back buffer of the port, other ports get a copy.
+ * While two senders are merged the port gets the merged frame instead.
+ * With ArtSync active the frames are only staged, they are published and
+ * sent out together when the ArtSync arrives.
+ */
+void handleArtnet() {
+    globalStruct *in;
+    while ((in = artnetQueue.front()) != NULL) {
+        uint8_t targets = routes.targets(in->universe);
+        int last = -1;
+        for (int port = 0; port < dmxPorts; port++) {
+            if (targets & ROUTE_PORT(port)) last = port;
+        }
+        for (int port = 0; port <= last; port++) {
+            if (!(targets & ROUTE_PORT(port))) continue;
+            packetReceived = true;
+            millis_dmxready = millis();
+            dmxUMatchCounter++;
+            globalStruct *frame = global[port].back();
+            globalStruct *current = global[port].latest();
+            uint16_t length;
+            int result = merge[port].update(in->source, in->universe, in->data, in->length, current->data, current->length,
+                                            frame->data, &length, millis());
+            if (result == MERGE_IGNORED) continue;
+            frame->universe = in->universe;
+            frame->sequence = in->sequence;
+            frame->source = in->source;
+            frame->length = in->length;
+            if (result == MERGE_MERGED) {
+                frame->length = length;
+            } else if (port == last) {
+                uint8_t *data = frame->data;
+                frame->data = in->data;
+                in->data = data;
+            } else {
+                memcpy(frame->data, in->data, in->length);
+            }
+            if (artsync.active(millis())) {
+                artsync.stage(port, in->source);
+            } else {
+                global[port].publish();
+            }
+        }
+        artnetQueue.pop();
     }
+
+    uint8_t synced = artsync.commit(millis());
+    if (synced) {
+        for (int port = 0; port < dmxPorts; port++) {
+            if (synced & ROUTE_PORT(port)) global[port].publish();
+        }
+        dmx.sync();
+        if (dmxPorts > 1) dmx2.sync();
+    }
+    artnetAccepted = artnetQueue.accepted();
+    artnetCoalesced = artnetQueue.coalesced();
+    artnetDropped = artnetQueue.dropped();
 }
 
 
 /*
  * Set fill dmx buffer to value every 8 channels  
  */
-void setDmxBuf(int c, uint8_t v) {
-    for (int i=0; i<=64; i++) {
-        global.data[c+i*8]=v;
+void setDmxBuf(uint8_t *buf, int c, uint8_t v) {
+    for (int i=0; (c+i*8) < FRAME_SIZE; i++) {
+        buf[c+i*8]=v;
     }
 }
 
@@ -282,26 +488,33 @@ void powerOnShow (int ch1, int numch) {
 #endif    
     if (ch1==0) { return; } // poweron show disabled
 
+    globalStruct *frame;
+
     // enable DMX driver
     digitalWrite(PIN_DMX_ENABLE, HIGH);
 
     // mode 0 = some pattern on all DMX channels
     if (numch==0) {
         for (int i=0; i<=60; i++) {
+            frame = global[0].edit();
             for (int j=1; j<=8; j++) {
-                setDmxBuf(ch1+j-2,abs(int(0xff*sin(i*PI/20+j*PI/8))));
-//                global.data[ch1+j-2] = abs(int(0xff*sin(i*PI/20+j*PI/8)));
+                setDmxBuf(frame->data,ch1+j-2,abs(int(0xff*sin(i*PI/20+j*PI/8))));
+//                frame->data[ch1+j-2] = abs(int(0xff*sin(i*PI/20+j*PI/8)));
             }
+            global[0].publish();
             sendDmxData(0);
             delay(20); 
         }
         for (int i=1; i<=8; i++) {
+            frame = global[0].edit();
             for (int j=1; j<=8; j++) {
-                setDmxBuf(i,pOnPat[i][j]);
+                setDmxBuf(frame->data,i,pOnPat[i][j]);
             }
+            global[0].publish();
             sendDmxData(0);
             delay(10); 
         }
+        dmx.flush();
         digitalWrite(PIN_DMX_ENABLE, LOW);
         return;
     }    
@@ -317,8 +530,10 @@ void powerOnShow (int ch1, int numch) {
 #ifdef REMOTEDEBUG          
             debugD("Pattern1: i%d, led=%d\n",i,0xff*(i%2));
 #endif
-            global.data[ch1-1] = abs(int(0xff*sin(i*PI/20)));
-//            global.data[ch1-1] = 0xff*(i%2);
+            frame = global[0].edit();
+            frame->data[ch1-1] = abs(int(0xff*sin(i*PI/20)));
+//            frame->data[ch1-1] = 0xff*(i%2);
+            global[0].publish();
             sendDmxData(0);
             LED.setColor(LED_YELLOW);
             delay(20);
@@ -326,18 +541,22 @@ void powerOnShow (int ch1, int numch) {
             
 //            delay(100);
         }
+        dmx.flush();
         digitalWrite(PIN_DMX_ENABLE, LOW);
         return;
     }
 
     // pattern for more than 1 channel
     for (int i=0; i<=60; i++) {
+        frame = global[0].edit();
         for (int j=1; j<=numch; j++) {
-            global.data[ch1+j-2] = abs(int(0xff*sin(i*PI/20+j*PI/numch)));
+            frame->data[ch1+j-2] = abs(int(0xff*sin(i*PI/20+j*PI/numch)));
         }
+        global[0].publish();
         sendDmxData(0);
         delay(20); 
     }
+    dmx.flush();
     digitalWrite(PIN_DMX_ENABLE, LOW);
     return;
 }
@@ -347,7 +566,8 @@ void powerOnShow (int ch1, int numch) {
  */
 void setup() {
     // set up serial port and display boot message with version
-    Serial.begin(115200);
+    // TX only, the UART interrupt is taken over by the DMX output
+    Serial.begin(115200, SERIAL_8N1, SERIAL_TX_ONLY);
     while (!Serial) { ; }
     Serial.printf("\nESP-DMX: Version %d.%d, Build %s Initializing ...\n",version_mayor,version_minor,build);
 
@@ -366,20 +586,17 @@ void setup() {
     // set up 2ns serial port for DMX output and a pin for the Max485 enable
     pinMode(PIN_DMX_ENABLE, OUTPUT);
     digitalWrite(PIN_DMX_ENABLE, LOW);   // disable the Max driver initially
+    pinMode(PIN_DMX2_ENABLE, OUTPUT);
+    digitalWrite(PIN_DMX2_ENABLE, LOW);
     Serial1.begin(250000, SERIAL_8N2);
-
-    // Set up DMX buffer
-    global.universe = 0;
-    global.sequence = 0;
-    global.length = 512;
-    global.data = (uint8_t *)malloc(512);
-    for (int i = 0; i < 512; i++) global.data[i] = 0;
+    dmx.begin();
 
     // Start SPIFFS used for configuration
     Serial.println("ESP-DMX: initializing SPIFFS");
     SPIFFS.begin();
 
     // Attempt to get config from SPIFFS
+    PROFILE_BEGIN(PROF_SETUP_CONFIG);
     Serial.println("ESP-DMX: load config");
     if (loadConfig()) {
         Serial.println("ESP-DMX: config loaded");
@@ -393,11 +610,31 @@ void setup() {
     }
 
     Serial.print("Hostname: ");Serial.println(config.hostname);
-    Serial.print("Universe: ");Serial.println(config.universe);
+    Serial.print("Ports:    ");Serial.println(config.ports);
     Serial.print("Channels: ");Serial.println(config.channels);
     Serial.print("Delay:    ");Serial.println(config.delay);
 
+    // Set up DMX buffers, the second port goes out through I2S
+    dmxPorts = MAX(1, MIN(config.ports, DMX_PORTS));
+    for (int port = 0; port < dmxPorts; port++) global[port].begin();
+    artnetQueue.begin();
+    for (int port = 0; port < DMX_PORTS; port++) merge[port].setMode(config.mergeMode);
+    if (!buildRoutes()) Serial.println("ESP-DMX: routes '"+config.routes+"' not valid, ignored");
+    Serial.print("Universe: ");Serial.print(portUniverse(0));
+    if (dmxPorts > 1) { Serial.print(", ");Serial.print(portUniverse(1)); }
+    Serial.println();
+    if (dmxPorts > 1) dmx2.begin(PIN_DMX_OUT);
+
+    // DMX break timing, out of range values are clamped to the E1.11 limits
+    if (!setBreakTiming(config.breakus, config.mabus)) {
+        Serial.printf("ESP-DMX: break/MAB %d/%d adjusted to %d/%d\n",config.breakus,config.mabus,breakTime(),mabTime());
+        config.breakus = breakTime();
+        config.mabus = mabTime();
+    }
+    PROFILE_END(PROF_SETUP_CONFIG);
+
     // Start Wifi
+    PROFILE_BEGIN(PROF_SETUP_WIFI);
 #ifdef WIFIMANAGER
     Serial.println("ESP-DMX: starting wifiManager");
   
@@ -431,6 +668,7 @@ void setup() {
     Serial.println(WiFi.hostname());
     Serial.print("IP: ");
     Serial.println(WiFi.localIP());
+    PROFILE_END(PROF_SETUP_WIFI);
 
 #ifdef REMOTEDEBUG
     // set up RemoteDebug
@@ -439,6 +677,7 @@ void setup() {
 #endif
     
     // Set up webinterface
+    PROFILE_BEGIN(PROF_SETUP_NETWORK);
     Serial.println("ESP-DMX: setting up webserver");
 
     webServer.onNotFound(http_error404);
@@ -451,6 +690,15 @@ void setup() {
     webServer.on("/update",      HTTP_GET, []         { millis_web = millis(); http_update(); });
     webServer.on("/update",     HTTP_POST, ota_restart, ota_upload);
     webServer.on("/pos",         HTTP_GET, []         { http_pos(); });
+    webServer.on("/monitor",     HTTP_GET, []         { http_monitor(); });
+    webServer.on("/sources",     HTTP_GET, []         { http_sources(); });
+    webServer.on("/api/status",  HTTP_GET, []         { http_api_status(); });
+    webServer.on("/metrics",     HTTP_GET, []         { http_metrics(); });
+    const char *headers[] = { "If-None-Match" };
+    webServer.collectHeaders(headers, 1);
+#ifdef LOOP_PROFILE
+    webServer.on("/profile",     HTTP_GET, []         { http_profile(); });
+#endif
 
     webServer.begin();
 
@@ -461,11 +709,24 @@ void setup() {
 
     // initialize artnet
     Serial.println("ESP-DMX: starting artnet");
-    artnetnode.setName(config.hostname.c_str());
-    artnetnode.setNumPorts(1);
-    artnetnode.enableDMXOutput(0);
-    artnetnode.begin();
-    artnetnode.setArtDmxCallback(onArtnetFrame);
+    artnetnode.setDmxFilter(onArtnetFrame);
+    uint8_t mac[6];
+    IPAddress ip = WiFi.localIP();
+    uint8_t ipBytes[4] = { ip[0], ip[1], ip[2], ip[3] };
+    WiFi.macAddress(mac);
+    pollReply.begin(ipBytes, mac, version_mayor, version_minor);
+    pollReply.setStatus(0xe0, 0x0f);   // indicators normal, set by web browser / web config, DHCP, 15 bit Port-Address
+    artnetnode.setPollReply(&pollReply);
+    artnetnode.setSync(onArtnetSync);
+    artnetnode.setStats(&senders);
+    if (!artnetnode.begin(&artnetQueue)) Serial.println("ESP-DMX: cannot open the artnet port !!!");
+
+    // initialize sACN, joins the multicast groups of the routed universes
+    Serial.println("ESP-DMX: starting sACN");
+    sacn.setDmxFilter(onSacnFrame);
+    sacn.setStats(&senders);
+    if (!sacn.begin(&artnetQueue)) Serial.println("ESP-DMX: cannot open the sACN port !!!");
+    PROFILE_END(PROF_SETUP_NETWORK);
     
     // initialize timestamps
     millis_dmxsend  = millis()-config.delay;
@@ -473,41 +734,41 @@ void setup() {
     millis_web    = 0;
     millis_dmxready = 0;
     millis_checkversion = 0;
+    millis_dmxfps = millis();
+
+    // periodic work, tasks first, housekeeping jobs when there is time left
+    scheduler.addTask(taskArtnet, 5);
+    scheduler.addTask(taskDmx2, 5);
+    scheduler.addTask(taskDmxOutput, 10);
+    scheduler.addJob(jobLed, 20);
+    scheduler.addJob(jobWeb, 5);
+    scheduler.addJob(jobMdns, 100);
+    scheduler.addJob(jobTemperature, 500);
+    scheduler.addJob(jobFrameStats, 1000);
+    scheduler.addJob(jobStatusLine, 5000);
+    versionCheckBegin(VERSIONCHECKINTERVAL);
+    scheduler.addJob(jobVersionCheck, 20);
+    monitorBegin();
+    scheduler.addJob(jobMonitor, 10);
     Serial.println("ESP-DMX: setup done");
     
     powerOnShow(config.pOnShowCh1,config.pOnShowNumCh);   
 } // setup
 
 /*
- * Main loop for processing
+ * DMX output control, high priority task
+ * Starts or stops the output with respect to what was received
  */
-void loop() {
-#ifdef REMOTEDEBUG
-    Debug.handle();
-#endif
-    LED.handle();
-    
-    readTemperature();
-
-    fanControl();
-    
-
-    // handle web service
-    webServer.handleClient();
-  
-    // handle artnet
-    artnetnode.read();
-
-    // handle zeroconf
-    MDNS.update();
-
-    // Main processing here
+void taskDmxOutput() {
+    PROFILE_STAGE(PROF_DMX_OUTPUT);
+    static bool wifiLost = false;
     if (WiFi.status() != WL_CONNECTED) {
-        // If no wifi, then show red LED
+        // If no wifi, then show red LED, the task period paces the checks
         LED.setColor(LED_ORANGE);
-        Serial.println("ESP-DMX loop: No wifi connection !!!");
-        delay(500);
+        if (!wifiLost) Serial.println("ESP-DMX loop: No wifi connection !!!");
+        wifiLost = true;
     } else {
+        wifiLost = false;
         if ((millis() - millis_web) < 1000) {
             //
             // If there was a web interaction, then show blue LED for 2 seconds, DMX sending is paused
@@ -523,12 +784,11 @@ void loop() {
             //
             LED.setColor(LED_GREEN);
             status = STATUS_DMX_RECEIVED;
-            digitalWrite(PIN_DMX_ENABLE, HIGH);
             //
-            // Send frame at configured framerate
+            // Send frames at configured framerate
             //
             packetReceived = false;
-            sendDmxData(config.delay);
+            runDmxOutput();
         } else if ((millis() - millis_dmxready) < config.holdsecs*1000) {
             //
             // There was matching artnet frame in the last config.holdsecs seconds !
@@ -537,41 +797,126 @@ void loop() {
             //
             LED.setColor(LED_GREEN,150);
             status = STATUS_DMX_HOLDING;
-            digitalWrite(PIN_DMX_ENABLE, HIGH);
-            sendDmxData(config.delay);
+            runDmxOutput();
         } else if ((millis() - millis_artnetreceived) < 2000) {
             //
             // There was an artnet frame seen, show cyan LED
             //
             LED.setColor(LED_CYAN);
             status = STATUS_DMX_SEEN;
-            digitalWrite(PIN_DMX_ENABLE, LOW);
+            stopDmxOutput();
         } else {
             //
             // No DMX received show redy state
             //
             status = STATUS_READY;
             LED.setColor(LED_GREEN,1000);
-            digitalWrite(PIN_DMX_ENABLE, LOW);
+            stopDmxOutput();
         }
     }
-    // Status line every 5 seconds
-    if ((millis() - millis_serialstatus) > 5000) {
-        last_rssi = WiFi.RSSI();
-        millis_serialstatus = millis();
-        Serial.printf("ESP-DMX loop: status = %s, RSSI=%i, dmxPacket=%d (u=%d), dmxUMatch=%d, u=%d, dmx sent=%d\n",
-                       status_text[status],last_rssi,artnetPacketCounter,seen_universe,dmxUMatchCounter,config.universe,dmxFrameCounter);
+}
+
+/*
+ * Keep the I2S output fed, high priority task
+ */
+void taskDmx2() {
+    PROFILE_STAGE(PROF_DMX2);
+    if (dmxPorts > 1) dmx2.handle();
+}
+
+/*
+ * Art-Net and sACN intake, high priority task
+ * Everything received since the last pass
+ */
+void taskArtnet() {
+    PROFILE_STAGE(PROF_ARTNET);
+    handleArtnet();
+    handleArtnetPoll();
+}
+
+/*
+ * Housekeeping jobs, run in the time the tasks leave
+ */
+void jobLed() {
+    PROFILE_STAGE(PROF_LED);
+#ifdef REMOTEDEBUG
+    Debug.handle();
+#endif
+    LED.handle();
+}
+
+void jobTemperature() {
+    PROFILE_STAGE(PROF_TEMPERATURE);
+    readTemperature();
+    fanControl();
+}
+
+void jobWeb() {
+    PROFILE_STAGE(PROF_WEB);
+    webServer.handleClient();
+}
+
+void jobMdns() {
+    PROFILE_STAGE(PROF_MDNS);
+    MDNS.update();
+}
+
+/*
+ * Frame statistics of the output scheduler, once a second
+ */
+void jobFrameStats() {
+    PROFILE_STAGE(PROF_FRAME_STATS);
+    dmxFrameStats dmxStats = dmx.stats();
+    dmxFrameCounter = dmxStats.frames;
+    dmxskip = dmxStats.overruns;
+    dmxloop = dmxStats.lastPeriod;
+    if (dmx.running() && millis() != millis_dmxfps) {
+        dmxFps[config.shortFrames ? 1 : 0] = (dmxFrameCounter - dmxFpsFrames) * 1000 / (millis() - millis_dmxfps);
+    }
+    dmxFpsFrames = dmxFrameCounter;
+    millis_dmxfps = millis();
+}
+
+/*
+ * Status line every 5 seconds
+ */
+void jobStatusLine() {
+    PROFILE_STAGE(PROF_STATUS_LINE);
+    last_rssi = WiFi.RSSI();
+    millis_serialstatus = millis();
+    Serial.printf("ESP-DMX loop: status = %s, RSSI=%i, dmxPacket=%d (u=%d), sacn=%d, queued=%d/%d/%d, lost/reord/dup=%d/%d/%d, dmxUMatch=%d, u=%d, dmx sent=%d, u2=%d, dmx2 sent=%d\n",
+                   status_text[status],last_rssi,artnetPacketCounter,seen_universe,sacn.packets(),artnetAccepted,artnetCoalesced,artnetDropped,
+                   sequence.lost(),sequence.reordered(),sequence.duplicates(),
+                   dmxUMatchCounter,portUniverse(0),dmxFrameCounter,portUniverse(1),dmx2.frames());
 #ifdef REMOTEDEBUG                       
-        debugV("ESP-DMX: status = %s, RSSI=%i, dmxPacket=%d (u=%d), dmxUMatch=%d, u=%d, dmx sent=%d",
-                       status_text[status],last_rssi,artnetPacketCounter,seen_universe,dmxUMatchCounter,config.universe,dmxFrameCounter);
+    debugV("ESP-DMX: status = %s, RSSI=%i, dmxPacket=%d (u=%d), dmxUMatch=%d, u=%d, dmx sent=%d",
+                   status_text[status],last_rssi,artnetPacketCounter,seen_universe,dmxUMatchCounter,portUniverse(0),dmxFrameCounter);
 #endif                       
-    }      
+}
 
-    debugval = millis() - millis_checkversion;
-    if ((millis() - millis_checkversion ) > VERSIONCHECKINTERVAL ) {
-        millis_checkversion = millis();
-        checkForNewVersion();
-    }
-    // limit loop speed
-    delay(1);
+/*
+ * Version check, a bit of it every pass, see version_check.h
+ */
+void jobVersionCheck() {
+    PROFILE_STAGE(PROF_VERSION_CHECK);
+    if (checkForNewVersion()) millis_checkversion = millis();
+}
+
+/*
+ * Live channel monitor, pushes the changed channels to the WebSocket clients
+ */
+void jobMonitor() {
+    PROFILE_STAGE(PROF_MONITOR);
+    monitorHandle();
+}
+
+/*
+ * Main loop for processing
+ * All work is done by the scheduler, the rest of the time is slept
+ */
+void loop() {
+    uint32_t idle = scheduler.runOnce();
+    // sleep until the next deadline, a received packet ends the sleep early
+    if (idle > 0) esp_delay(idle, []() { return !scheduler.woken(); });
+    else yield();
 } // loop
@@ -0,0 +1,140 @@
+/*
+ * Compiled HTML templates, generated by tools/html2progmem.py from
+ * html/head.html html/foot.html html/config.html html/monitor.html
+ * Do not edit, change the templates and run it again
+ */
+
+#ifndef _HTML_PAGES_H_
+#define _HTML_PAGES_H_
+
+#include "html_template.h"
+
+void html_breakus();
+void html_channels();
+void html_delay();
+void html_fwURL();
+void html_holdsecs();
+void html_hostname();
+void html_mabus();
+void html_mergeMode();
+void html_monitorPort();
+void html_monitorPorts();
+void html_nav();
+void html_pOnShowCh1();
+void html_pOnShowNumCh();
+void html_ports();
+void html_refresh();
+void html_routes();
+void html_shortFrames();
+void html_universe();
+void html_universe2();
+
+const char PROGMEM html_head_text[] =
+    "<head><title></title></head>\n"
+    "<body><h1 style='text-align: center;'></h1>\n"
+    "<table style='width:100%;border: 1px solid black; text-align: center;'>\n"
+    "<tr></tr>\n"
+    "</table>\n";
+const htmlSlot PROGMEM html_head_slots[] = {
+    { 13, html_hostname },
+    { 21, html_refresh },
+    { 67, html_hostname },
+    { 149, html_nav },
+};
+const htmlTemplate PROGMEM html_head = { html_head_text, 164, html_head_slots, 4 };
+
+const char PROGMEM html_foot_text[] =
+    "<p><hr style='width:100%; height:1px; border:none; color:red; background:black;'>\n"
+    "<p>ESP-DMX by Markus Baertschi, <a href=https://github.com/markusb>github.com/markusb/esp-dmx</a>\n"
+    "</body>\n";
+const htmlTemplate PROGMEM html_foot = { html_foot_text, 188, NULL, 0 };
+
+const char PROGMEM html_config_text[] =
+    "<form id='config' method='post' action='/config'><p><table style='width:100%;'>\n"
+    "<tr><td>Hostname:</td><td><input type='text' id='hostname' name='hostname' value='' required></td></tr>\n"
+    "<tr><td>Universe configured:</td><td><input type='text' id='universe' name='universe' value='' required></td></tr>\n"
+    "<tr><td>Output ports (1 or 2, takes effect after restart):</td><td><input type='text' id='ports' name='ports' value='' required></td></tr>\n"
+    "<tr><td>Universe port 2 (I2S, GPIO3):</td><td><input type='text' id='universe2' name='universe2' value='' required></td></tr>\n"
+    "<tr><td>Routes, instead of the universe of a port (net.sub.uni=port, ...):</td><td><input type='text' id='routes' name='routes' value=''></td></tr>\n"
+    "<tr><td>Channels configured:</td><td><input type='text' id='channels' name='channels' value='' required></td></tr>\n"
+    "<tr><td>Delay configured:</td><td><input type='text' id='delay' name='delay' value='' required></td></tr>\n"
+    "<tr><td>Seconds to hold last state after signal loss:</td><td><input type='text' id='holdsecs' name='holdsecs' value='' required></td></tr>\n"
+    "<tr><td>URL for updates:</td><td><input type='text' id='fwURL' name='fwURL' value='' required></td></tr>\n"
+    "<tr><td>PowerOnShow 1st channel:</td><td><input type='text' id='pOnShowCh1' name='pOnShowCh1' value='' required>(0=Off)</td></tr>\n"
+    "<tr><td>PowerOnShow mode/number of channels:</td><td><input type='text' id='pOnShowNumCh' name='pOnShowNumCh' value='' required></td></tr>\n"
+    "<tr><td>DMX break (us, min 92):</td><td><input type='text' id='breakus' name='breakus' value='' required></td></tr>\n"
+    "<tr><td>DMX mark after break (us, min 12):</td><td><input type='text' id='mabus' name='mabus' value='' required></td></tr>\n"
+    "<tr><td>Short frames, send only used channels at max rate:</td><td><input type='text' id='shortFrames' name='shortFrames' value='' required>(0=Off)</td></tr>\n"
+    "<tr><td>Merge mode for two senders:</td><td><input type='text' id='mergeMode' name='mergeMode' value='' required>(0=HTP, 1=LTP)</td></tr>\n"
+    "<tr><td></td><td><button name='save' type='submit'>Save Config</button></td></tr>\n"
+    "<tr><td colspan=2 align=center><button name='formdefaults' type='submit'>Reset config to defaults</button> <button name='wifidefaults' type='submit'>Reset wifi config</button> <button name='alldefaults' type='submit'>Reset config & wifi</button></td></tr>\n"
+    "</table></form>\n";
+const htmlSlot PROGMEM html_config_slots[] = {
+    { 162, html_hostname },
+    { 277, html_universe },
+    { 416, html_ports },
+    { 542, html_universe2 },
+    { 699, html_routes },
+    { 805, html_channels },
+    { 911, html_delay },
+    { 1051, html_holdsecs },
+    { 1156, html_fwURL },
+    { 1279, html_pOnShowCh1 },
+    { 1425, html_pOnShowNumCh },
+    { 1541, html_breakus },
+    { 1664, html_mabus },
+    { 1815, html_shortFrames },
+    { 1946, html_mergeMode },
+};
+const htmlTemplate PROGMEM html_config = { html_config_text, 2336, html_config_slots, 15 };
+
+const char PROGMEM html_monitor_text[] =
+    "<p>Port <select id='port'></select>\n"
+    "max <select id='rate'><option>1</option><option>2</option><option>5</option><option selected>10</option><option>20</option><option>30</option></select> frames/s\n"
+    "<span id='state'>connecting</span>\n"
+    "<div id='grid' style='display:grid; grid-template-columns:repeat(16,1fr); font-family:monospace; font-size:small; text-align:center;'></div>\n"
+    "<script>\n"
+    "var ch = new Uint8Array(512), cells = [], ws;\n"
+    "var grid = document.getElementById('grid'), port = document.getElementById('port'), rate = document.getElementById('rate'), state = document.getElementById('state');\n"
+    "for (var i = 0; i < 512; i++) { var d = document.createElement('div'); d.title = i + 1; cells.push(grid.appendChild(d)); }\n"
+    "function draw(n) {\n"
+    "  for (var i = 0; i < 512; i++) {\n"
+    "    var v = i < n ? String(ch[i]) : '';\n"
+    "    if (cells[i].textContent == v) continue;\n"
+    "    cells[i].textContent = v;\n"
+    "    cells[i].style.background = i < n ? 'rgb(' + (255 - ch[i]) + ',255,' + (255 - ch[i]) + ')' : '#eee';\n"
+    "  }\n"
+    "}\n"
+    "// frame format see monitor_rle.h\n"
+    "function apply(b) {\n"
+    "  var n = (b[2] << 8) | b[3], p = 4, pos = 0;\n"
+    "  if (b[0] == 1) ch.fill(0);\n"
+    "  while (p + 3 <= b.length) {\n"
+    "    pos += (b[p] << 8) | b[p + 1];\n"
+    "    var c = b[p + 2], k = (c & 127) + 1;\n"
+    "    p += 3;\n"
+    "    if (c & 128) { ch.fill(b[p++], pos, pos + k); pos += k; }\n"
+    "    else { for (var j = 0; j < k; j++) ch[pos++] = b[p++]; }\n"
+    "  }\n"
+    "  draw(n);\n"
+    "}\n"
+    "function choose() { state.textContent = 'live'; ws.send('port=' + port.value + ' rate=' + rate.value); }\n"
+    "function connect() {\n"
+    "  ws = new WebSocket('ws://' + location.hostname + ':/');\n"
+    "  ws.binaryType = 'arraybuffer';\n"
+    "  ws.onopen = choose;\n"
+    "  ws.onclose = function() { state.textContent = 'reconnecting'; setTimeout(connect, 2000); };\n"
+    "  ws.onmessage = function(e) { if (typeof e.data == 'string') state.textContent = e.data; else apply(new Uint8Array(e.data)); };\n"
+    "}\n"
+    "port.onchange = choose;\n"
+    "rate.onchange = choose;\n"
+    "draw(0);\n"
+    "connect();\n"
+    "</script>\n";
+const htmlSlot PROGMEM html_monitor_slots[] = {
+    { 26, html_monitorPorts },
+    { 1562, html_monitorPort },
+};
+const htmlTemplate PROGMEM html_monitor = { html_monitor_text, 1925, html_monitor_slots, 2 };
+
+#endif
@@ -0,0 +1,24 @@
+/*
+ * Compiled HTML templates
+ */
+
+#include "html_template.h"
+
+/*
+ * Write a template, span() gets the text between the slots
+ */
+void htmlRender(const htmlTemplate *t, void (*span)(PGM_P text, size_t len)) {
+    PGM_P text = (PGM_P)pgm_read_ptr(&t->text);
+    uint16_t length = pgm_read_word(&t->length);
+    const htmlSlot *slots = (const htmlSlot *)pgm_read_ptr(&t->slots);
+    uint8_t count = pgm_read_byte(&t->count);
+    uint16_t done = 0;
+    for (int i = 0; i < count; i++) {
+        uint16_t offset = pgm_read_word(&slots[i].offset);
+        htmlGetter get = (htmlGetter)pgm_read_ptr(&slots[i].get);
+        if (offset > done) span(text + done, offset - done);
+        get();
+        done = offset;
+    }
+    if (length > done) span(text + done, length - done);
+}
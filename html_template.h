@@ -0,0 +1,44 @@
+/*
+ * Compiled HTML templates
+ *
+ * The pages in html/ are turned into html_pages.h by tools/html2progmem.py,
+ * see build-notes. Each template is the page text in flash with the
+ * placeholders taken out, and a table of the offsets where they were with
+ * the function that writes the value. Rendering copies the spans between
+ * the offsets and calls the functions in between. The tables are in flash
+ * as well and read with pgm_read_*().
+ */
+
+#ifndef _HTML_TEMPLATE_H_
+#define _HTML_TEMPLATE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <pgmspace.h>
+#else
+#define PROGMEM
+typedef const char *PGM_P;
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_ptr(p) (*(const void * const *)(p))
+#endif
+
+typedef void (*htmlGetter)(void);
+
+struct htmlSlot {
+    uint16_t offset;      // in the text
+    htmlGetter get;       // writes the value
+};
+
+struct htmlTemplate {
+    PGM_P text;
+    uint16_t length;
+    const htmlSlot *slots;
+    uint8_t count;
+};
+
+void htmlRender(const htmlTemplate *t, void (*span)(PGM_P text, size_t len));
+
+#endif
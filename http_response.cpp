@@ -0,0 +1,136 @@
+/*
+ * HTTP request and response of the version check, in fixed buffers
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "http_response.h"
+
+/*
+ * Conditional GET, empty validators are left out
+ * Returns the length, -1 when it does not fit
+ */
+int httpRequest(char *buf, size_t size, const char *host, const char *path, const char *etag, const char *lastModified) {
+    int n = snprintf(buf, size, "GET %s HTTP/1.0\r\nHost: %s\r\nUser-Agent: ESP8266 esp-dmx\r\n%s%s%s%s%s%s\r\n",
+                     path, host,
+                     etag[0] ? "If-None-Match: " : "", etag, etag[0] ? "\r\n" : "",
+                     lastModified[0] ? "If-Modified-Since: " : "", lastModified, lastModified[0] ? "\r\n" : "");
+    return ((n < 0) || ((size_t)n >= size)) ? -1 : n;
+}
+
+httpResponse::httpResponse() {
+    this->begin();
+}
+
+/*
+ * Ready for the next response
+ */
+void httpResponse::begin() {
+    this->lineLength = 0;
+    this->etagValue[0] = 0;
+    this->modifiedValue[0] = 0;
+    this->text[0] = 0;
+    this->textLength = 0;
+    this->status = 0;
+    this->inBody = false;
+    this->contentLength = -1;
+    this->received = 0;
+}
+
+/*
+ * The next piece of the response
+ */
+void httpResponse::feed(const uint8_t *data, int length) {
+    for (int i = 0; i < length; i++) {
+        char c = data[i];
+        if (this->inBody) {
+            this->received++;
+            if (this->textLength < HTTP_BODY_MAX) {
+                this->text[this->textLength++] = c;
+                this->text[this->textLength] = 0;
+            }
+        } else if (c == '\n') {
+            this->line[this->lineLength] = 0;
+            this->header();
+            this->lineLength = 0;
+        } else if ((c != '\r') && (this->lineLength < HTTP_LINE_MAX - 1)) {
+            this->line[this->lineLength++] = c;
+        }
+    }
+}
+
+/*
+ * One line of the response head, the status line or a header
+ */
+void httpResponse::header() {
+    if (this->status == 0) {
+        const char *space = strchr(this->line, ' ');
+        this->status = space ? atoi(space + 1) : -1;
+        if (this->status == 0) this->status = -1;
+        return;
+    }
+    if (this->lineLength == 0) {
+        this->inBody = true;
+        return;
+    }
+    char *colon = strchr(this->line, ':');
+    if (colon == NULL) return;
+    *colon = 0;
+    char *value = colon + 1;
+    while (*value == ' ' || *value == '\t') value++;
+    char *end = value + strlen(value);
+    while ((end > value) && (end[-1] == ' ' || end[-1] == '\t')) *--end = 0;
+    if (strcasecmp(this->line, "content-length") == 0) {
+        this->contentLength = atol(value);
+        return;
+    }
+    char *to = NULL;
+    if (strcasecmp(this->line, "etag") == 0) to = this->etagValue;
+    if (strcasecmp(this->line, "last-modified") == 0) to = this->modifiedValue;
+    if (to == NULL) return;
+    strncpy(to, value, HTTP_VALIDATOR_MAX - 1);
+    to[HTTP_VALIDATOR_MAX - 1] = 0;
+}
+
+/*
+ * The empty line after the headers came in
+ */
+bool httpResponse::headDone() {
+    return this->inBody;
+}
+
+/*
+ * HTTP status, 0 before the status line, -1 when it is not one
+ */
+int httpResponse::code() {
+    return this->status;
+}
+
+const char *httpResponse::etag() {
+    return this->etagValue;
+}
+
+const char *httpResponse::lastModified() {
+    return this->modifiedValue;
+}
+
+/*
+ * The body received so far, terminated
+ */
+const char *httpResponse::body() {
+    return this->text;
+}
+
+uint16_t httpResponse::bodyLength() {
+    return this->textLength;
+}
+
+/*
+ * Whether the whole body came in, always true without Content-Length as
+ * the end of the connection ends the body then
+ */
+bool httpResponse::complete() {
+    return (this->contentLength < 0) || (this->received >= (uint32_t)this->contentLength);
+}
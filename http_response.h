@@ -0,0 +1,57 @@
+/*
+ * HTTP request and response of the version check, in fixed buffers
+ *
+ * The request asks for HTTP/1.0, so the server answers with a plain body
+ * up to the end of the connection and never with chunked transfer
+ * encoding. feed() takes the response as it arrives, in pieces of any
+ * size: the status line, ETag, Last-Modified and Content-Length from the
+ * head, then up to HTTP_BODY_MAX bytes of body. Longer header lines and
+ * bodies are cut. complete() tells a body cut off by the connection from
+ * a whole one, when the server sent its length.
+ *
+ * No Arduino in here, the parser is checked on a Linux host against a
+ * stand-in server, see tests/test_http_response.cpp.
+ */
+
+#ifndef _HTTP_RESPONSE_H_
+#define _HTTP_RESPONSE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HTTP_LINE_MAX 128         // header line, longer ones are cut
+#define HTTP_VALIDATOR_MAX 64     // ETag or Last-Modified
+#define HTTP_BODY_MAX 512         // the release file is a few lines
+
+int httpRequest(char *buf, size_t size, const char *host, const char *path, const char *etag, const char *lastModified);
+
+class httpResponse {
+    public:
+        httpResponse();
+
+        void begin();
+        void feed(const uint8_t *data, int length);
+        bool headDone();
+        int code();
+        const char *etag();
+        const char *lastModified();
+        const char *body();
+        uint16_t bodyLength();
+        bool complete();
+
+    private:
+        char line[HTTP_LINE_MAX];
+        uint16_t lineLength;
+        char etagValue[HTTP_VALIDATOR_MAX];
+        char modifiedValue[HTTP_VALIDATOR_MAX];
+        char text[HTTP_BODY_MAX + 1];
+        uint16_t textLength;
+        int status;
+        bool inBody;
+        int32_t contentLength;    // -1 when the server did not send it
+        uint32_t received;        // body bytes, those cut off included
+
+        void header();
+};
+
+#endif
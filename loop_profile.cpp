@@ -0,0 +1,82 @@
+/*
+ * Profiler for the stages of setup() and loop()
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "loop_profile.h"
+
+static const char *stageNames[PROF_STAGES] = {
+    "setup_config",
+    "setup_wifi",
+    "setup_network",
+    "artnet",
+    "dmx2",
+    "dmx_output",
+    "led",
+    "web",
+    "mdns",
+    "temperature",
+    "frame_stats",
+    "status_line",
+    "version_check",
+    "monitor",
+};
+
+loopProfile::loopProfile() {
+    this->reset();
+}
+
+/*
+ * Add one measurement of a stage
+ */
+void loopProfile::record(int stage, uint32_t cycles) {
+    if ((stage < 0) || (stage >= PROF_STAGES)) return;
+    profileEntry *e = &this->stages[stage];
+    e->count++;
+    e->total += cycles;
+    if (cycles > e->max) e->max = cycles;
+    int bucket = (cycles == 0) ? 0 : 31 - __builtin_clz(cycles);
+    if (bucket >= PROFILE_BUCKETS) bucket = PROFILE_BUCKETS - 1;
+    e->histogram[bucket]++;
+}
+
+void loopProfile::reset() {
+    memset(this->stages, 0, sizeof(this->stages));
+}
+
+const profileEntry *loopProfile::entry(int stage) {
+    if ((stage < 0) || (stage >= PROF_STAGES)) return NULL;
+    return &this->stages[stage];
+}
+
+const char *loopProfile::name(int stage) {
+    if ((stage < 0) || (stage >= PROF_STAGES)) return "";
+    return stageNames[stage];
+}
+
+/*
+ * One stage as a JSON object, the histogram up to the last used bucket
+ * Returns the length, 0 when it does not fit
+ */
+int loopProfile::json(int stage, char *buf, size_t size) {
+    const profileEntry *e = this->entry(stage);
+    if (e == NULL) return 0;
+    int used = 0;
+    for (int i = 0; i < PROFILE_BUCKETS; i++) {
+        if (e->histogram[i]) used = i + 1;
+    }
+    int len = snprintf(buf, size, "{\"stage\":\"%s\",\"count\":%lu,\"total\":%llu,\"max\":%lu,\"histogram\":[",
+                       stageNames[stage], (unsigned long)e->count, (unsigned long long)e->total, (unsigned long)e->max);
+    if ((len < 0) || ((size_t)len >= size)) return 0;
+    for (int i = 0; i < used; i++) {
+        int n = snprintf(buf + len, size - len, "%s%lu", i ? "," : "", (unsigned long)e->histogram[i]);
+        if ((n < 0) || ((size_t)n >= size - len)) return 0;
+        len += n;
+    }
+    if ((size_t)len + 3 > size) return 0;
+    buf[len++] = ']';
+    buf[len++] = '}';
+    buf[len] = 0;
+    return len;
+}
@@ -0,0 +1,91 @@
+/*
+ * Profiler for the stages of setup() and loop()
+ *
+ * Each stage is measured with the CPU cycle counter, counting calls, total
+ * and maximum cycles and a histogram of the durations by powers of two.
+ * Enable with LOOP_PROFILE below, without it PROFILE_STAGE() compiles to
+ * nothing and /profile is not served.
+ */
+
+#ifndef _LOOP_PROFILE_H_
+#define _LOOP_PROFILE_H_
+
+//#define LOOP_PROFILE
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROFILE_BUCKETS 24    // bucket n counts durations of 2^n..2^(n+1)-1 cycles, the last one all above
+
+enum profileStage {
+    PROF_SETUP_CONFIG,
+    PROF_SETUP_WIFI,
+    PROF_SETUP_NETWORK,
+    PROF_ARTNET,
+    PROF_DMX2,
+    PROF_DMX_OUTPUT,
+    PROF_LED,
+    PROF_WEB,
+    PROF_MDNS,
+    PROF_TEMPERATURE,
+    PROF_FRAME_STATS,
+    PROF_STATUS_LINE,
+    PROF_VERSION_CHECK,
+    PROF_MONITOR,
+    PROF_STAGES
+};
+
+struct profileEntry {
+    uint32_t count;
+    uint64_t total;       // cycles
+    uint32_t max;
+    uint32_t histogram[PROFILE_BUCKETS];
+};
+
+class loopProfile {
+    public:
+        loopProfile();
+
+        void record(int stage, uint32_t cycles);
+        void reset();
+        const profileEntry *entry(int stage);
+        const char *name(int stage);
+        int json(int stage, char *buf, size_t size);
+
+    private:
+        profileEntry stages[PROF_STAGES];
+};
+
+#ifdef LOOP_PROFILE
+
+#ifdef ARDUINO
+#include <Esp.h>
+#define PROFILE_CYCLES() ESP.getCycleCount()
+#else
+#define PROFILE_CYCLES() 0
+#endif
+
+extern loopProfile profile;
+
+// measures from here to the end of the enclosing block
+struct profileScope {
+    int stage;
+    uint32_t start;
+    profileScope(int stage) : stage(stage), start(PROFILE_CYCLES()) { }
+    ~profileScope() { profile.record(this->stage, PROFILE_CYCLES() - this->start); }
+};
+
+#define PROFILE_STAGE(stage) profileScope _profileScope(stage)
+// for sections of one function, like setup(), cycles wrap after some 26s at 160MHz
+#define PROFILE_BEGIN(stage) uint32_t _profile_##stage = PROFILE_CYCLES()
+#define PROFILE_END(stage) profile.record(stage, PROFILE_CYCLES() - _profile_##stage)
+
+#else
+
+#define PROFILE_STAGE(stage) do { } while (0)
+#define PROFILE_BEGIN(stage) do { } while (0)
+#define PROFILE_END(stage) do { } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+/*
+ * Counters in the Prometheus text format, for /metrics
+ */
+
+#include "metrics.h"
+
+#define METRIC_HEAD(name, type, help) "# HELP " name " " help "\n# TYPE " name " " type "\n"
+
+/*
+ * One sample, the fragment has the name and labels, in flash
+ */
+static void metric(Print &out, const __FlashStringHelper *fragment, int64_t value) {
+    out.print(fragment);
+    if (value < 0) {
+        out.write('-');
+        value = -value;
+    }
+    out.print((unsigned long)value);
+    out.write('\n');
+}
+
+void metricsWrite(const metricsValues *v, Print &out) {
+    metric(out, F(METRIC_HEAD("esp_dmx_artnet_packets_total", "counter", "ArtDmx packets seen, any universe")
+                  "esp_dmx_artnet_packets_total "), v->artnetPackets);
+    metric(out, F(METRIC_HEAD("esp_dmx_sacn_packets_total", "counter", "sACN data packets seen, any universe")
+                  "esp_dmx_sacn_packets_total "), v->sacnPackets);
+    metric(out, F(METRIC_HEAD("esp_dmx_matched_frames_total", "counter", "Frames routed to an output port")
+                  "esp_dmx_matched_frames_total "), v->matched);
+    metric(out, F(METRIC_HEAD("esp_dmx_ring_frames_total", "counter", "Frames through the receive ring")
+                  "esp_dmx_ring_frames_total{result=\"queued\"} "), v->queued);
+    metric(out, F("esp_dmx_ring_frames_total{result=\"coalesced\"} "), v->coalesced);
+    metric(out, F("esp_dmx_ring_frames_total{result=\"dropped\"} "), v->dropped);
+    metric(out, F(METRIC_HEAD("esp_dmx_sequence_errors_total", "counter", "Sequence errors of received frames")
+                  "esp_dmx_sequence_errors_total{kind=\"lost\"} "), v->lost);
+    metric(out, F("esp_dmx_sequence_errors_total{kind=\"reordered\"} "), v->reordered);
+    metric(out, F("esp_dmx_sequence_errors_total{kind=\"duplicate\"} "), v->duplicates);
+    metric(out, F(METRIC_HEAD("esp_dmx_frames_total", "counter", "DMX frames sent")
+                  "esp_dmx_frames_total{port=\"1\"} "), v->frames[0]);
+    if (v->ports > 1) metric(out, F("esp_dmx_frames_total{port=\"2\"} "), v->frames[1]);
+    metric(out, F(METRIC_HEAD("esp_dmx_late_frames_total", "counter", "DMX frames started late, previous frame still going")
+                  "esp_dmx_late_frames_total "), v->late);
+    metric(out, F(METRIC_HEAD("esp_dmx_frame_period_microseconds", "gauge", "Last measured DMX frame period")
+                  "esp_dmx_frame_period_microseconds "), v->period);
+    metric(out, F(METRIC_HEAD("esp_dmx_frame_jitter_max_microseconds", "gauge", "Largest deviation of a frame start from the schedule")
+                  "esp_dmx_frame_jitter_max_microseconds "), v->jitterMax);
+    metric(out, F(METRIC_HEAD("esp_dmx_monitor_clients", "gauge", "Clients of the live channel monitor")
+                  "esp_dmx_monitor_clients "), v->monitorClients);
+    metric(out, F(METRIC_HEAD("esp_dmx_monitor_frames_total", "counter", "Frames sent to monitor clients")
+                  "esp_dmx_monitor_frames_total "), v->monitorFrames);
+    metric(out, F(METRIC_HEAD("esp_dmx_monitor_bytes_total", "counter", "Bytes of frames sent to monitor clients")
+                  "esp_dmx_monitor_bytes_total "), v->monitorBytes);
+    metric(out, F(METRIC_HEAD("esp_dmx_monitor_skipped_total", "counter", "Monitor frames skipped, the client had no room for them")
+                  "esp_dmx_monitor_skipped_total "), v->monitorSkipped);
+    metric(out, F(METRIC_HEAD("esp_dmx_temperature_celsius", "gauge", "Device temperature")
+                  "esp_dmx_temperature_celsius "), v->temperature);
+    metric(out, F(METRIC_HEAD("esp_dmx_fan_speed", "gauge", "Fan speed, 0-1024")
+                  "esp_dmx_fan_speed "), v->fanspeed);
+    metric(out, F(METRIC_HEAD("esp_dmx_wifi_rssi_dbm", "gauge", "Wifi signal strength")
+                  "esp_dmx_wifi_rssi_dbm "), v->rssi);
+    metric(out, F(METRIC_HEAD("esp_dmx_free_heap_bytes", "gauge", "Free heap")
+                  "esp_dmx_free_heap_bytes "), v->freeHeap);
+    metric(out, F(METRIC_HEAD("esp_dmx_uptime_seconds", "gauge", "Seconds since boot")
+                  "esp_dmx_uptime_seconds "), v->uptime);
+}
@@ -0,0 +1,46 @@
+/*
+ * Counters in the Prometheus text format, for /metrics
+ *
+ * The values are collected into metricsValues and written to a Print,
+ * the page writer on the node. HELP, TYPE and the sample names are text
+ * in flash, only the numbers are formatted per scrape. Counters end in
+ * _total, everything else is a gauge.
+ *
+ * Builds on a Linux host with the stand-ins of tests/host, the output is
+ * checked there with a parser of the text format.
+ */
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <Arduino.h>
+
+struct metricsValues {
+    uint32_t artnetPackets;
+    uint32_t sacnPackets;
+    uint32_t matched;
+    uint32_t queued;
+    uint32_t coalesced;
+    uint32_t dropped;
+    uint32_t lost;
+    uint32_t reordered;
+    uint32_t duplicates;
+    int ports;
+    uint32_t frames[2];
+    uint32_t late;
+    uint32_t period;          // us, last measured frame period of port 1
+    int32_t jitterMax;        // us
+    int monitorClients;
+    uint32_t monitorFrames;
+    uint32_t monitorBytes;
+    uint32_t monitorSkipped;
+    int temperature;
+    int fanspeed;
+    int rssi;
+    uint32_t freeHeap;
+    uint32_t uptime;          // s
+};
+
+void metricsWrite(const metricsValues *v, Print &out);
+
+#endif
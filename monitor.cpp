@@ -0,0 +1,212 @@
+/*
+ * Live channel monitor over a WebSocket
+ */
+
+#include "monitor.h"
+
+static const uint8_t monitorRates[] = { 1, 2, 5, 10, 20, MONITOR_RATE_MAX };   // Hz, a few steps so clients share streams
+
+#define MONITOR_NONE 0xff
+
+dmxMonitor::dmxMonitor(void (*yield)(void)) : server(MONITOR_PORT) {
+    this->yield = yield;
+    this->source = NULL;
+    this->ports = 0;
+    this->framesSent = 0;
+    this->bytesSent = 0;
+    this->framesSkipped = 0;
+    for (int i = 0; i < MONITOR_CLIENTS; i++) {
+        this->streams[i].port = MONITOR_NONE;
+        this->streams[i].snapshot = NULL;
+        this->streams[i].clients = 0;
+        this->streams[i].waiting = 0;
+        this->member[i] = -1;
+        this->stalled[i] = 0;
+    }
+}
+
+/*
+ * Start the WebSocket server, frames are taken from the latest frame of each port
+ */
+void dmxMonitor::begin(frameBuffer *frames, int ports) {
+    this->source = frames;
+    this->ports = ports;
+    this->server.onEvent([this](uint8_t num, WStype_t type, uint8_t *payload, size_t length) {
+        this->event(num, type, payload, length);
+    });
+    this->server.begin();
+    Serial.printf("Monitor: WebSocket on port %d\n", MONITOR_PORT);
+}
+
+/*
+ * Serve the WebSocket and push to the streams that are due
+ */
+void dmxMonitor::handle() {
+    this->server.loop();
+    uint32_t now = millis();
+    for (int i = 0; i < MONITOR_CLIENTS; i++) {
+        monitorStream *s = &this->streams[i];
+        if (s->clients == 0) continue;
+        if ((uint32_t)(now - s->lastPush) < s->interval) continue;
+        s->lastPush = now;
+        this->push(s);
+    }
+}
+
+int dmxMonitor::clients() {
+    return this->server.connectedClients();
+}
+
+uint32_t dmxMonitor::frames() {
+    return this->framesSent;
+}
+
+uint32_t dmxMonitor::bytes() {
+    return this->bytesSent;
+}
+
+/*
+ * Frames not sent as the client had no room for them
+ */
+uint32_t dmxMonitor::skipped() {
+    return this->framesSkipped;
+}
+
+void dmxMonitor::event(uint8_t num, WStype_t type, uint8_t *payload, size_t length) {
+    if (num >= MONITOR_CLIENTS) return;
+    switch (type) {
+        case WStype_CONNECTED:
+            this->join(num, 1, MONITOR_RATE);
+            break;
+        case WStype_DISCONNECTED:
+            this->leave(num);
+            break;
+        case WStype_TEXT: {
+            // "port=1 rate=10", both optional, the library terminates the payload
+            int port = 1;
+            int rate = MONITOR_RATE;
+            if (this->member[num] >= 0) {
+                monitorStream *s = &this->streams[this->member[num]];
+                port = s->port + 1;
+                rate = 1000 / s->interval;
+            }
+            const char *p = strstr((const char *)payload, "port=");
+            if (p) port = atoi(p + 5);
+            p = strstr((const char *)payload, "rate=");
+            if (p) rate = atoi(p + 5);
+            this->join(num, port, rate);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/*
+ * Move a client to the stream of port (1 based) and rate, the stream is made if needed
+ */
+void dmxMonitor::join(uint8_t num, int port, int rate) {
+    if (port < 1 || port > this->ports) {
+        char text[32];
+        snprintf(text, sizeof(text), "no port %d", port);
+        this->server.sendTXT(num, text);
+        return;
+    }
+    uint8_t hz = monitorRates[0];
+    for (size_t i = 0; i < sizeof(monitorRates); i++) {
+        if (monitorRates[i] <= rate) hz = monitorRates[i];
+    }
+    uint16_t interval = 1000 / hz;
+    this->leave(num);
+
+    int unused = -1;
+    int found = -1;
+    for (int i = 0; i < MONITOR_CLIENTS; i++) {
+        monitorStream *s = &this->streams[i];
+        if (s->port == port - 1 && s->interval == interval) { found = i; break; }
+        if (s->port == MONITOR_NONE && unused < 0) unused = i;
+    }
+    if (found < 0) {
+        if (unused < 0) return;
+        monitorStream *s = &this->streams[unused];
+        s->snapshot = (uint8_t *)malloc(512);
+        if (!s->snapshot) {
+            Serial.println("Monitor: out of memory");
+            return;
+        }
+        s->port = port - 1;
+        s->interval = interval;
+        s->lastPush = millis() - interval;
+        found = unused;
+    }
+    monitorStream *s = &this->streams[found];
+    s->clients |= 1 << num;
+    s->waiting |= 1 << num;
+    this->member[num] = found;
+    this->stalled[num] = 0;
+    Serial.printf("Monitor: client %d on port %d at %d Hz\n", num, port, hz);
+}
+
+/*
+ * Take a client out of its stream, the last one frees the snapshot
+ */
+void dmxMonitor::leave(uint8_t num) {
+    if (this->member[num] < 0) return;
+    monitorStream *s = &this->streams[this->member[num]];
+    this->member[num] = -1;
+    s->clients &= ~(1 << num);
+    s->waiting &= ~(1 << num);
+    if (s->clients == 0) {
+        free(s->snapshot);
+        s->snapshot = NULL;
+        s->port = MONITOR_NONE;
+    }
+}
+
+/*
+ * Encode the stream once and send it to all its clients
+ * When a client waits for a full frame, all of them get it, so their
+ * view of the channels beyond the frame length stays the same
+ */
+void dmxMonitor::push(monitorStream *s) {
+    globalStruct *f = this->source[s->port].latest();
+    uint16_t count = f->length > 512 ? 512 : f->length;
+    int len;
+    if (s->waiting) {
+        len = rleEncode(MONITOR_FULL, s->port + 1, NULL, f->data, count, this->frame, sizeof(this->frame));
+        memset(s->snapshot + count, 0, 512 - count);
+        s->waiting = 0;
+    } else {
+        len = rleEncode(MONITOR_DELTA, s->port + 1, s->snapshot, f->data, count, this->frame, sizeof(this->frame));
+        if (len == MONITOR_HEADER) return;    // nothing changed
+    }
+    if (len < 0) return;
+    memcpy(s->snapshot, f->data, count);
+    this->send(s, len);
+}
+
+/*
+ * Send the frame to the clients of s that have room for it, sendBIN()
+ * would wait for the others
+ * A skipped client missed a delta, it waits for a full frame from now on
+ */
+void dmxMonitor::send(monitorStream *s, int len) {
+    uint32_t clients = s->clients;
+    for (int i = 0; i < MONITOR_CLIENTS; i++) {
+        if (!(clients & (1 << i))) continue;
+        if (this->server.room(i) < (size_t)len + MONITOR_WS_HEADER) {
+            this->framesSkipped++;
+            s->waiting |= 1 << i;
+            if (++this->stalled[i] >= MONITOR_STALL_MAX) {
+                Serial.printf("Monitor: client %d stalled, dropped\n", i);
+                this->server.disconnect(i);     // leave() runs from the event
+            }
+            continue;
+        }
+        this->stalled[i] = 0;
+        this->server.sendBIN(i, this->frame, len);
+        this->framesSent++;
+        this->bytesSent += len;
+        if (this->yield) this->yield();
+    }
+}
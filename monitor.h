@@ -0,0 +1,84 @@
+/*
+ * Live channel monitor over a WebSocket
+ *
+ * Clients connect to port MONITOR_PORT and send a text message such as
+ * "port=1 rate=10" to pick the DMX port and the highest push rate in Hz.
+ * Clients with the same port and rate form a stream. Every interval the
+ * stream encodes the changes against its snapshot once, see monitor_rle.h,
+ * and sends that binary frame to all its clients. A client that just
+ * joined gets a full frame first. Nothing is sent when nothing changed.
+ *
+ * The monitor runs as a housekeeping job, between the sends the yield
+ * function gives the DMX and Art-Net tasks their turn. A send never waits
+ * for a client: one without room for the frame in its TCP send buffer is
+ * skipped and gets a full frame once it has room again, after
+ * MONITOR_STALL_MAX skips in a row it is dropped.
+ */
+
+#ifndef _MONITOR_H_
+#define _MONITOR_H_
+
+#include <Arduino.h>
+#include <WebSocketsServer.h>     // https://github.com/Links2004/arduinoWebSockets
+#include "dmx_frames.h"
+#include "monitor_rle.h"
+
+#define MONITOR_PORT 81
+#define MONITOR_CLIENTS WEBSOCKETS_SERVER_CLIENT_MAX
+#define MONITOR_RATE 10           // Hz, until the client asks for another one
+#define MONITOR_RATE_MAX 30       // Hz
+#define MONITOR_STALL_MAX 20      // pushes skipped in a row before a client is dropped
+#define MONITOR_WS_HEADER 4       // WebSocket header of a binary frame up to 64k
+
+struct monitorStream {
+    uint8_t port;             // 0 based, 0xff when the stream is not used
+    uint16_t interval;        // ms
+    uint32_t lastPush;        // ms
+    uint8_t *snapshot;        // 512 channels as last sent
+    uint32_t clients;         // bit per client
+    uint32_t waiting;         // clients still waiting for a full frame
+};
+
+// the client list of the library is protected, this gets at the TCP send buffer
+class monitorServer : public WebSocketsServer {
+    public:
+        monitorServer(uint16_t port) : WebSocketsServer(port) {}
+
+        size_t room(uint8_t num) {
+            WSclient_t *c = &this->_clients[num];
+            return (c->tcp && c->tcp->connected()) ? c->tcp->availableForWrite() : 0;
+        }
+};
+
+class dmxMonitor {
+    public:
+        dmxMonitor(void (*yield)(void));
+
+        void begin(frameBuffer *frames, int ports);
+        void handle();
+        int clients();
+        uint32_t frames();
+        uint32_t bytes();
+        uint32_t skipped();
+
+    private:
+        monitorServer server;
+        void (*yield)(void);
+        frameBuffer *source;
+        int ports;
+        monitorStream streams[MONITOR_CLIENTS];
+        int8_t member[MONITOR_CLIENTS];     // stream of each client, -1 for none
+        uint8_t stalled[MONITOR_CLIENTS];   // pushes skipped in a row
+        uint8_t frame[MONITOR_FRAME_MAX];
+        uint32_t framesSent;
+        uint32_t bytesSent;
+        uint32_t framesSkipped;
+
+        void event(uint8_t num, WStype_t type, uint8_t *payload, size_t length);
+        void join(uint8_t num, int port, int rate);
+        void leave(uint8_t num);
+        void push(monitorStream *s);
+        void send(monitorStream *s, int len);
+};
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Delta encoding of DMX universes for the live channel monitor
+ */
+
+#include "monitor_rle.h"
+
+#define RLE_MIN_RUN 4     // shorter repeats go into literals
+#define RLE_BREAK_RUN 8   // repeats that end a literal, a new segment costs 3 bytes
+#define RLE_MAX 128       // values per segment
+#define RLE_GAP 3         // unchanged channels a literal may span, cheaper than a new segment
+
+// value of channel i before, all zero for a full frame
+static inline uint8_t before(const uint8_t *prev, uint16_t i) {
+    return prev ? prev[i] : 0;
+}
+
+/*
+ * Encode the changes of cur against prev (NULL for a full frame)
+ * Returns the frame length, MONITOR_HEADER when nothing changed, -1 when out is too small
+ */
+int rleEncode(uint8_t type, uint8_t port, const uint8_t *prev, const uint8_t *cur, uint16_t channels, uint8_t *out, size_t size) {
+    if (size < MONITOR_HEADER) return -1;
+    out[0] = type;
+    out[1] = port;
+    out[2] = channels >> 8;
+    out[3] = channels & 0xff;
+    size_t len = MONITOR_HEADER;
+    uint16_t pos = 0;     // first channel not yet covered
+
+    while (pos < channels) {
+        uint16_t start = pos;
+        while ((start < channels) && (cur[start] == before(prev, start))) start++;
+        if (start >= channels) break;
+
+        // a run of the same value
+        uint16_t run = 1;
+        while ((start + run < channels) && (run < RLE_MAX) && (cur[start + run] == cur[start])) run++;
+        if (len + 4 > size) return -1;
+        out[len++] = (start - pos) >> 8;
+        out[len++] = (start - pos) & 0xff;
+        if (run >= RLE_MIN_RUN) {
+            out[len++] = 0x80 | (run - 1);
+            out[len++] = cur[start];
+            pos = start + run;
+            continue;
+        }
+
+        // literal up to the next longer run, or the end of the changes
+        uint16_t end = start;
+        uint16_t last = start;   // last changed channel
+        while ((end < channels) && (end - start < RLE_MAX)) {
+            if ((end > start) && (end + RLE_BREAK_RUN <= channels)) {
+                uint16_t same = 1;
+                while ((same < RLE_BREAK_RUN) && (cur[end + same] == cur[end])) same++;
+                if (same == RLE_BREAK_RUN) break;
+            }
+            if (cur[end] != before(prev, end)) {
+                last = end;
+            } else if (end - last > RLE_GAP) {
+                break;
+            }
+            end++;
+        }
+        end = last + 1;   // no unchanged tail
+        uint16_t count = end - start;
+        if (len + 1 + count > size) return -1;
+        out[len++] = count - 1;
+        for (uint16_t i = start; i < end; i++) out[len++] = cur[i];
+        pos = end;
+    }
+    return len;
+}
+
+/*
+ * Apply a frame to channels, a full frame clears all size of them first
+ * Returns the number of channels of the frame, -1 for a broken frame
+ */
+int rleDecode(const uint8_t *in, size_t len, uint8_t *channels, uint16_t size) {
+    if (len < MONITOR_HEADER) return -1;
+    uint16_t count = (in[2] << 8) | in[3];
+    if (count > size) return -1;
+    if (in[0] == MONITOR_FULL) {
+        for (uint16_t i = 0; i < size; i++) channels[i] = 0;
+    }
+    size_t p = MONITOR_HEADER;
+    uint16_t pos = 0;
+    while (p < len) {
+        if (p + 3 > len) return -1;
+        pos += (in[p] << 8) | in[p + 1];
+        uint8_t control = in[p + 2];
+        p += 3;
+        uint16_t n = (control & 0x7f) + 1;
+        if (pos + n > count) return -1;
+        if (control & 0x80) {
+            if (p >= len) return -1;
+            for (uint16_t i = 0; i < n; i++) channels[pos++] = in[p];
+            p++;
+        } else {
+            if (p + n > len) return -1;
+            for (uint16_t i = 0; i < n; i++) channels[pos++] = in[p++];
+        }
+    }
+    return count;
+}
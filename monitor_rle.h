@@ -0,0 +1,30 @@
+/*
+ * Delta encoding of DMX universes for the live channel monitor
+ *
+ * A frame carries only the channels that changed against the previous
+ * frame sent, as run-length encoded segments:
+ *
+ *   header  type (MONITOR_DELTA or MONITOR_FULL), port, channels (16 bit, big endian)
+ *   segment skip (16 bit, big endian), control, data
+ *
+ * skip is the number of unchanged channels before the segment. control
+ * below 0x80 is followed by control+1 literal values, from 0x80 on by one
+ * value repeated (control & 0x7f)+1 times. A full frame is a delta against
+ * all channels at zero.
+ */
+
+#ifndef _MONITOR_RLE_H_
+#define _MONITOR_RLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MONITOR_DELTA 0
+#define MONITOR_FULL 1
+#define MONITOR_HEADER 4
+#define MONITOR_FRAME_MAX (MONITOR_HEADER + 512 + 3 * 512 / 128 + 3)   // all channels as literals
+
+int rleEncode(uint8_t type, uint8_t port, const uint8_t *prev, const uint8_t *cur, uint16_t channels, uint8_t *out, size_t size);
+int rleDecode(const uint8_t *in, size_t len, uint8_t *channels, uint16_t size);
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Routing of Art-Net Port-Addresses to the outputs
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "route_table.h"
+#include "dmx_hw.h"
+
+routeTable::routeTable() {
+    this->clear();
+}
+
+void routeTable::clear() {
+    memset(this->bits, 0, sizeof(this->bits));
+    this->routes = 0;
+}
+
+/*
+ * Route address to targets, a route already in the table gets the targets added
+ * Returns false if the address is invalid, a target already has another
+ * address or the table is full
+ */
+bool routeTable::add(uint16_t address, uint8_t targets) {
+    if (address >= ROUTE_ADDRESSES) return false;
+    for (int i = 0; i < this->routes; i++) {
+        if ((this->address[i] != address) && (this->mask[i] & targets)) return false;
+    }
+    for (int i = 0; i < this->routes; i++) {
+        if (this->address[i] == address) {
+            this->mask[i] |= targets;
+            return true;
+        }
+    }
+    if (this->routes >= ROUTE_MAX) return false;
+    this->address[this->routes] = address;
+    this->mask[this->routes] = targets;
+    this->routes++;
+    this->bits[address >> 5] |= 1UL << (address & 31);
+    return true;
+}
+
+/*
+ * Add routes from text like "0.0.5=1, 0.1.0=2, 300=1"
+ * An address is Net.SubNet.Universe or the Port-Address as one number,
+ * the target is an output port counted from 1 up to maxPort
+ * Returns the number of routes added, -1 on a syntax error, an address
+ * out of range or a port that already has another address
+ */
+int routeTable::parse(const char *text, uint8_t maxPort) {
+    int added = 0;
+    const char *p = text;
+
+    while (*p) {
+        while ((*p == ' ') || (*p == ',')) p++;
+        if (*p == 0) break;
+
+        long part[3];
+        int parts = 0;
+        char *end;
+        do {
+            if (parts > 0) p++;   // skip the dot
+            part[parts++] = strtol(p, &end, 10);
+            if (end == p) return -1;
+            p = end;
+        } while ((*p == '.') && (parts < 3));
+
+        long address;
+        if (parts == 1) {
+            if ((part[0] < 0) || (part[0] >= ROUTE_ADDRESSES)) return -1;
+            address = part[0];
+        } else if (parts == 3) {
+            if ((part[0] < 0) || (part[0] > 127) || (part[1] < 0) || (part[1] > 15) || (part[2] < 0) || (part[2] > 15)) return -1;
+            address = (part[0] << 8) | (part[1] << 4) | part[2];
+        } else {
+            return -1;
+        }
+
+        while (*p == ' ') p++;
+        if (*p++ != '=') return -1;
+        long port = strtol(p, &end, 10);
+        if ((end == p) || (port < 1) || (port > maxPort)) return -1;
+        p = end;
+
+        if (!this->add(address, ROUTE_PORT(port - 1))) return -1;
+        added++;
+    }
+    return added;
+}
+
+/*
+ * Whether address has a route, constant time
+ */
+bool ICACHE_RAM_ATTR routeTable::routed(uint16_t address) {
+    if (address >= ROUTE_ADDRESSES) return false;
+    return this->bits[address >> 5] & (1UL << (address & 31));
+}
+
+/*
+ * Targets of address, 0 if it is not routed
+ */
+uint8_t routeTable::targets(uint16_t address) {
+    if (!this->routed(address)) return 0;
+    for (int i = 0; i < this->routes; i++) {
+        if (this->address[i] == address) return this->mask[i];
+    }
+    return 0;
+}
+
+int routeTable::count() {
+    return this->routes;
+}
+
+/*
+ * Port-Address of route i, for i below count()
+ */
+uint16_t routeTable::addressAt(int i) {
+    return this->address[i];
+}
+
+/*
+ * Port-Address routed to output port, -1 if the port has no route
+ */
+int routeTable::portAddress(uint8_t port) {
+    for (int i = 0; i < this->routes; i++) {
+        if (this->mask[i] & ROUTE_PORT(port)) return this->address[i];
+    }
+    return -1;
+}
+
+/*
+ * Print the table in the format parse() reads, one entry per target
+ * Returns the length of the text
+ */
+int routeTable::print(char *buf, size_t size) {
+    size_t len = 0;
+    buf[0] = 0;
+    for (int i = 0; i < this->routes; i++) {
+        uint16_t a = this->address[i];
+        for (int port = 0; port < 8; port++) {
+            if (!(this->mask[i] & ROUTE_PORT(port))) continue;
+            int n = snprintf(buf + len, size - len, "%s%d.%d.%d=%d", len ? ", " : "", a >> 8, (a >> 4) & 0x0f, a & 0x0f, port + 1);
+            if ((n < 0) || ((size_t)n >= size - len)) return len;
+            len += n;
+        }
+    }
+    return len;
+}
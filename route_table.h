@@ -0,0 +1,42 @@
+/*
+ * Routing of Art-Net Port-Addresses to the outputs
+ *
+ * Maps full 15 bit Port-Addresses (Net/SubNet/Universe) to a bit mask of
+ * targets, bit n is output port n. An output port takes one address only,
+ * a frame always covers the whole port. Whether an address is routed at all is
+ * answered from a bitset over the whole address space, so the payload of
+ * unrouted universes is rejected in constant time before any copy.
+ */
+
+#ifndef _ROUTE_TABLE_H_
+#define _ROUTE_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ROUTE_ADDRESSES 32768   // 15 bit Port-Address
+#define ROUTE_MAX 16            // routes in the table
+#define ROUTE_PORT(n) (1 << (n))
+
+class routeTable {
+    public:
+        routeTable();
+
+        void clear();
+        bool add(uint16_t address, uint8_t targets);
+        int parse(const char *text, uint8_t maxPort);
+        bool routed(uint16_t address);
+        uint8_t targets(uint16_t address);
+        int count();
+        uint16_t addressAt(int i);
+        int portAddress(uint8_t port);
+        int print(char *buf, size_t size);
+
+    private:
+        uint32_t bits[ROUTE_ADDRESSES / 32];
+        uint16_t address[ROUTE_MAX];
+        uint8_t mask[ROUTE_MAX];
+        int routes;
+};
+
+#endif
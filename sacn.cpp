@@ -0,0 +1,287 @@
+/*
+ * sACN (ANSI E1.31) receiver
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "sacn.h"
+#include "dmx_frames.h"
+#ifdef ARDUINO
+#include "Arduino.h"
+#include "lwip/igmp.h"
+#endif
+
+static const uint8_t acnId[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+
+static inline uint16_t get16(const uint8_t *p) {
+    return (p[0] << 8) | p[1];
+}
+
+static inline uint32_t get32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+// PDU flags must be 0x7, the length counts from the flags to the end of the packet
+static inline bool pduOk(const uint8_t *p, uint16_t length) {
+    return ((p[0] & 0xf0) == 0x70) && ((get16(p) & 0x0fff) == length);
+}
+
+/*
+ * Check an E1.31 data packet of len bytes, buf holds at least the first
+ * SACN_HEADER bytes. Returns false for anything that is not valid DMX data.
+ */
+bool sacnParse(const uint8_t *buf, uint16_t len, sacnDmx *dmx) {
+    if (len < SACN_HEADER) return false;
+
+    // root layer
+    if ((get16(&buf[0]) != 0x0010) || (get16(&buf[2]) != 0x0000)) return false;
+    if (memcmp(&buf[4], acnId, sizeof(acnId)) != 0) return false;
+    if (!pduOk(&buf[16], len - 16) || (get32(&buf[18]) != 0x00000004)) return false;
+
+    // framing layer
+    if (!pduOk(&buf[38], len - 38) || (get32(&buf[40]) != 0x00000002)) return false;
+    uint16_t universe = get16(&buf[113]);
+    if ((universe == 0) || (universe > SACN_UNIVERSE_MAX) || (buf[108] > SACN_PRIORITY_MAX)) return false;
+
+    // DMP layer, one property array of the start code and up to 512 slots
+    if (!pduOk(&buf[115], len - 115) || (buf[117] != 0x02) || (buf[118] != 0xa1)) return false;
+    if ((get16(&buf[119]) != 0x0000) || (get16(&buf[121]) != 0x0001)) return false;
+    uint16_t count = get16(&buf[123]);
+    if ((count < 1) || (count > FRAME_SIZE + 1) || (len != SACN_HEADER - 1 + count)) return false;
+    if (buf[125] != 0) return false;   // only null start code data
+
+    dmx->universe = universe;
+    dmx->length = count - 1;
+    dmx->sequence = buf[111];
+    dmx->priority = buf[108];
+    dmx->options = buf[112];
+    dmx->cid = &buf[22];
+    return true;
+}
+
+/*
+ * 32 bit key of a 16 byte CID (FNV-1a), never 0 as that marks a free entry
+ * A source keeps its CID when its IP changes or several share one IP
+ */
+uint32_t sacnCidKey(const uint8_t *cid) {
+    uint32_t h = 2166136261UL;
+    for (int i = 0; i < 16; i++) {
+        h ^= cid[i];
+        h *= 16777619UL;
+    }
+    return h ? h : 1;
+}
+
+#ifdef ARDUINO
+/*
+ * lwIP receive callback, runs in the context of the network stack
+ */
+static void sacnRecv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port) {
+    ((sacnReceiver *)arg)->receive(p, ip_addr_get_ip4_u32(addr), millis());
+    pbuf_free(p);
+}
+#endif
+
+sacnReceiver::sacnReceiver() {
+    this->ring = NULL;
+    this->filter = NULL;
+    this->pcb = NULL;
+    this->stats = NULL;
+    memset(this->source, 0, sizeof(this->source));
+    this->groups = 0;
+    this->joined = false;
+    this->packetCount = 0;
+    this->invalidCount = 0;
+    this->ignoredCount = 0;
+}
+
+/*
+ * Open the sACN port and join the multicast groups, received frames go into ring
+ * Call when the network is up
+ */
+bool sacnReceiver::begin(artnetRing *ring) {
+    this->ring = ring;
+#ifdef ARDUINO
+    this->pcb = udp_new();
+    if (this->pcb == NULL) return false;
+    if (udp_bind(this->pcb, IP_ADDR_ANY, SACN_PORT) != ERR_OK) {
+        udp_remove(this->pcb);
+        this->pcb = NULL;
+        return false;
+    }
+    udp_recv(this->pcb, sacnRecv, this);
+#endif
+    this->joined = true;
+    for (int i = 0; i < this->groups; i++) this->joinGroup(this->group[i], true);
+    return true;
+}
+
+/*
+ * Called with Port-Address, sender IP, CID and sequence of every valid data
+ * packet of the source owning the universe, the payload is only copied
+ * when it returns true
+ */
+void sacnReceiver::setDmxFilter(bool (*filter)(uint16_t address, uint32_t source, const uint8_t *cid, uint8_t sequence)) {
+    this->filter = filter;
+}
+
+/*
+ * Count every data packet per sender in stats
+ */
+void sacnReceiver::setStats(sourceStats *stats) {
+    this->stats = stats;
+}
+
+/*
+ * Leave all multicast groups, addUniverse() joins them again
+ */
+void sacnReceiver::clearUniverses() {
+    for (int i = 0; i < this->groups; i++) this->joinGroup(this->group[i], false);
+    this->groups = 0;
+}
+
+/*
+ * Join the multicast group of universe, takes effect at once after begin()
+ */
+bool sacnReceiver::addUniverse(uint16_t universe) {
+    if ((universe == 0) || (universe > SACN_UNIVERSE_MAX)) return false;
+    for (int i = 0; i < this->groups; i++) {
+        if (this->group[i] == universe) return true;
+    }
+    if (this->groups >= SACN_GROUPS) return false;
+    this->group[this->groups++] = universe;
+    this->joinGroup(universe, true);
+    return true;
+}
+
+/*
+ * Whether universe was added, it may also arrive unicast or from a group
+ * another socket joined
+ */
+bool sacnReceiver::wanted(uint16_t universe) {
+    for (int i = 0; i < this->groups; i++) {
+        if (this->group[i] == universe) return true;
+    }
+    return false;
+}
+
+/*
+ * Join or leave the multicast group 239.255.hi.lo of universe, nothing before begin()
+ */
+void sacnReceiver::joinGroup(uint16_t universe, bool join) {
+    if (!this->joined) return;
+#ifdef ARDUINO
+    ip4_addr_t g;
+    IP4_ADDR(&g, 239, 255, universe >> 8, universe & 0xff);
+    if (join) {
+        igmp_joingroup(IP4_ADDR_ANY4, &g);
+    } else {
+        igmp_leavegroup(IP4_ADDR_ANY4, &g);
+    }
+#else
+    (void)universe;
+    (void)join;
+#endif
+}
+
+/*
+ * Decide whether the data of a packet is used, now in ms
+ * The source with the highest priority owns the universe until it times out
+ * or terminates the stream, sources of equal priority all get through
+ */
+bool sacnReceiver::arbitrate(const sacnDmx *dmx, uint32_t now) {
+    sacnSource *owner = NULL;
+    sacnSource *free = NULL;
+
+    for (int i = 0; i < SACN_SOURCES; i++) {
+        sacnSource *s = &this->source[i];
+        if ((s->universe != 0) && ((now - s->lastSeen) > SACN_TIMEOUT)) s->universe = 0;
+        if (s->universe == dmx->universe) owner = s;
+        if ((s->universe == 0) && (free == NULL)) free = s;
+    }
+
+    if (owner == NULL) {
+        if (dmx->options & SACN_OPT_TERMINATED) return false;
+        if (free == NULL) return true;   // no room to track, take it as it comes
+        owner = free;
+    } else if (memcmp(owner->cid, dmx->cid, 16) == 0) {
+        if (dmx->options & SACN_OPT_TERMINATED) {
+            owner->universe = 0;
+            return false;
+        }
+    } else if (dmx->priority < owner->priority) {
+        return false;
+    } else if (dmx->priority == owner->priority) {
+        return !(dmx->options & SACN_OPT_TERMINATED);
+    } else if (dmx->options & SACN_OPT_TERMINATED) {
+        return false;
+    }
+
+    owner->universe = dmx->universe;
+    memcpy(owner->cid, dmx->cid, 16);
+    owner->priority = dmx->priority;
+    owner->lastSeen = now;
+    return true;
+}
+
+/*
+ * Handle one received datagram from IPv4 address addr (network order), now in ms
+ * The pbuf stays owned by the caller
+ */
+void sacnReceiver::receive(struct pbuf *p, uint32_t addr, uint32_t now) {
+    uint8_t header[SACN_HEADER];
+    const uint8_t *buf = (const uint8_t *)p->payload;
+    sacnDmx dmx;
+
+    this->packetCount++;
+    if (p->len < SACN_HEADER) {
+        artnetCopy(p, 0, header, SACN_HEADER);
+        buf = header;
+    }
+    if (!sacnParse(buf, p->tot_len, &dmx)) {
+        this->invalidCount++;
+        return;
+    }
+
+    uint16_t address = dmx.universe - 1;
+    if (this->stats) this->stats->record(addr, address, true, dmx.sequence, p->tot_len, now);
+    // a universe that is not routed must not take a priority slot and a
+    // lower priority source must not reach the sequence check
+    if ((dmx.options & SACN_OPT_PREVIEW) || !this->wanted(dmx.universe) || !this->arbitrate(&dmx, now) ||
+        (this->filter && !this->filter(address, addr, dmx.cid, dmx.sequence))) {
+        this->ignoredCount++;
+        return;
+    }
+    if ((this->ring == NULL) || (dmx.length == 0)) return;
+
+    uint8_t *data = this->ring->reserve(address, addr);
+    if (data == NULL) return;
+    if (p->len >= SACN_HEADER + dmx.length) {
+        memcpy(data, buf + SACN_HEADER, dmx.length);
+    } else {
+        artnetCopy(p, SACN_HEADER, data, dmx.length);
+    }
+    this->ring->commit(dmx.length, dmx.sequence);
+}
+
+/*
+ * Datagrams received on the sACN port
+ */
+uint32_t sacnReceiver::packets() {
+    return this->packetCount;
+}
+
+/*
+ * Datagrams that were not valid E1.31 data packets
+ */
+uint32_t sacnReceiver::invalid() {
+    return this->invalidCount;
+}
+
+/*
+ * Valid packets not used: preview data, unrouted universe, out of sequence
+ * or lower priority
+ */
+uint32_t sacnReceiver::ignored() {
+    return this->ignoredCount;
+}
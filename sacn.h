@@ -0,0 +1,89 @@
+/*
+ * sACN (ANSI E1.31) receiver
+ *
+ * Receives E1.31 data packets on a raw lwIP UDP socket and joins the
+ * multicast group 239.255.hi.lo of each wanted universe. Root, framing and
+ * DMP layer are checked in place, nothing is allocated per packet. Of several
+ * sources sending the same universe the one with the highest priority wins,
+ * a source that stops sending is dropped after the E1.31 data loss timeout.
+ * Only the universes added with addUniverse() take part in that, others are
+ * ignored before they can use up a priority slot.
+ *
+ * Frames go into the same receive ring as Art-Net. sACN universe u feeds the
+ * Art-Net Port-Address u - 1, so sACN universe 1 is Art-Net 0.0.0.
+ */
+
+#ifndef _SACN_H_
+#define _SACN_H_
+
+#include <stdint.h>
+#include "artnet_ring.h"
+#include "artnet_udp.h"
+#include "source_stats.h"
+
+#define SACN_PORT 5568
+#define SACN_HEADER 126            // up to and including the start code
+#define SACN_UNIVERSE_MAX 63999
+#define SACN_PRIORITY_DEFAULT 100
+#define SACN_PRIORITY_MAX 200
+#define SACN_TIMEOUT 2500          // ms, network data loss
+#define SACN_SOURCES 8             // universes with priority tracking
+#define SACN_GROUPS 16             // multicast groups joined
+
+#define SACN_OPT_PREVIEW    0x80
+#define SACN_OPT_TERMINATED 0x40
+
+// Fields of an E1.31 data packet
+struct sacnDmx {
+    uint16_t universe;
+    uint16_t length;       // DMX slots without the start code
+    uint8_t sequence;
+    uint8_t priority;
+    uint8_t options;
+    const uint8_t *cid;    // 16 byte component id of the source, points into the packet
+};
+
+// Source currently owning a universe
+struct sacnSource {
+    uint16_t universe;     // 0 for a free entry
+    uint8_t cid[16];
+    uint8_t priority;
+    uint32_t lastSeen;
+};
+
+bool sacnParse(const uint8_t *buf, uint16_t len, sacnDmx *dmx);
+uint32_t sacnCidKey(const uint8_t *cid);
+
+class sacnReceiver {
+    public:
+        sacnReceiver();
+
+        bool begin(artnetRing *ring);
+        void setDmxFilter(bool (*filter)(uint16_t address, uint32_t source, const uint8_t *cid, uint8_t sequence));
+        void setStats(sourceStats *stats);
+        void clearUniverses();
+        bool addUniverse(uint16_t universe);
+        bool wanted(uint16_t universe);
+        bool arbitrate(const sacnDmx *dmx, uint32_t now);
+        void receive(struct pbuf *p, uint32_t addr, uint32_t now);
+        uint32_t packets();
+        uint32_t invalid();
+        uint32_t ignored();
+
+    private:
+        artnetRing *ring;
+        bool (*filter)(uint16_t address, uint32_t source, const uint8_t *cid, uint8_t sequence);
+        struct udp_pcb *pcb;
+        sourceStats *stats;
+        sacnSource source[SACN_SOURCES];
+        uint16_t group[SACN_GROUPS];
+        int groups;
+        bool joined;               // begin() done, groups are joined as they are added
+        uint32_t packetCount;
+        uint32_t invalidCount;
+        uint32_t ignoredCount;
+
+        void joinGroup(uint16_t universe, bool join);
+};
+
+#endif
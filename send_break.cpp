@@ -1,44 +1,57 @@
 /*
  * Send a break to restart the ouptut for DMX512
+ *
+ * The break is generated by forcing the UART TX line low with UART_TXD_BRK.
+ * The timing of break and MAB is done by the DMX output with timer1, no
+ * delays and no re-initialisation of the UART.
  */
 
 #include "send_break.h"
-#include "c_types.h"
-#include "eagle_soc.h"
-#include "uart_register.h"
-#include "Arduino.h"
+#include "dmx_hw.h"
 
 // More detailled information on the DMX protocol can be found on
 // http://www.erwinrol.com/dmx512/
 // https://erg.abdn.ac.uk/users/gorry/eg3576/DMX-frame.html
 
-// there are two different implementations, both should work
-#define USE_SERIAL_BREAK
-
-/* UART for DMX output */
-#define SEROUT_UART 1
-
-/* DMX minimum timings per E1.11 */
-#define DMX_BREAK 92
-#define DMX_MAB 12
-
-void sendBreak() {
-#ifdef USE_SERIAL_BREAK
-    // switch to another baud rate, see https://forum.arduino.cc/index.php?topic=382040.0
-    Serial1.flush();
-    Serial1.begin(90000, SERIAL_8N2);
-    while(Serial1.available()) Serial1.read();
-    // send the break as a "slow" byte
-    Serial1.write(0);
-    // switch back to the original baud rate
-    Serial1.flush();
-    Serial1.begin(250000, SERIAL_8N2);
-    while(Serial1.available()) Serial1.read();
-#else
-    // send break using low-level code
-    SET_PERI_REG_MASK(UART_CONF0(SEROUT_UART), UART_TXD_BRK);
-    delayMicroseconds(DMX_BREAK);
-    CLEAR_PERI_REG_MASK(UART_CONF0(SEROUT_UART), UART_TXD_BRK);
-    delayMicroseconds(DMX_MAB);
-#endif
+static uint16_t break_us = DMX_BREAK_DEFAULT;
+static uint16_t mab_us = DMX_MAB_DEFAULT;
+
+/*
+ * Set the length of break and MAB in microseconds
+ * Values outside the E1.11 limits are clamped and false is returned
+ */
+bool setBreakTiming(int breakus, int mabus) {
+    bool ok = true;
+    if (breakus < DMX_BREAK)     { breakus = DMX_BREAK; ok = false; }
+    if (breakus > DMX_BREAK_MAX) { breakus = DMX_BREAK_MAX; ok = false; }
+    if (mabus < DMX_MAB)         { mabus = DMX_MAB; ok = false; }
+    if (mabus > DMX_BREAK_MAX)   { mabus = DMX_BREAK_MAX; ok = false; }
+    break_us = breakus;
+    mab_us = mabus;
+    return ok;
+}
+
+/*
+ * Read from the timer1 interrupt, kept in IRAM like breakStart()/breakEnd()
+ */
+uint16_t ICACHE_RAM_ATTR breakTime() {
+    return break_us;
+}
+
+uint16_t ICACHE_RAM_ATTR mabTime() {
+    return mab_us;
+}
+
+/*
+ * Pull the line low, the FIFO must be empty
+ */
+void ICACHE_RAM_ATTR breakStart(int uart) {
+    dmxUartSetBreak(uart, true);
+}
+
+/*
+ * Release the line, the MAB starts now
+ */
+void ICACHE_RAM_ATTR breakEnd(int uart) {
+    dmxUartSetBreak(uart, false);
 }
@@ -5,6 +5,23 @@
 #ifndef _SEND_BREAK_H
 #define _SEND_BREAK_H
 
-void sendBreak(void);
+#include <stdint.h>
+
+/* DMX minimum timings per E1.11 */
+#define DMX_BREAK 92
+#define DMX_MAB 12
+
+/* Default timings, with some margin for slow receivers */
+#define DMX_BREAK_DEFAULT 120
+#define DMX_MAB_DEFAULT 16
+
+/* Upper limit for break and MAB, E1.11 allows up to 1s */
+#define DMX_BREAK_MAX 10000
+
+bool setBreakTiming(int breakus, int mabus);
+uint16_t breakTime(void);
+uint16_t mabTime(void);
+void breakStart(int uart);
+void breakEnd(int uart);
 
 #endif
@@ -0,0 +1,115 @@
+/*
+ * Statistics per Art-Net/sACN sender
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "source_stats.h"
+
+sourceStats::sourceStats() {
+    memset(this->table, 0, sizeof(this->table));
+}
+
+/*
+ * Close the rate window of e if it is over
+ * A sender that stopped sending shows a rate of 0 after two windows
+ */
+void sourceStats::roll(sourceEntry *e, uint32_t now) {
+    uint32_t age = now - e->windowStart;
+    if (age < SOURCE_WINDOW) return;
+    if (age < 2 * SOURCE_WINDOW) {
+        e->pps = (uint32_t)e->windowPackets * 1000 / age;
+        e->bps = (uint64_t)e->windowBytes * 1000 / age;
+    } else {
+        e->pps = 0;
+        e->bps = 0;
+    }
+    e->windowStart = now;
+    e->windowPackets = 0;
+    e->windowBytes = 0;
+}
+
+/*
+ * Count a DMX packet of bytes from ip for universe, now in ms
+ */
+void sourceStats::record(uint32_t ip, uint16_t universe, bool sacn, uint8_t sequence, uint16_t bytes, uint32_t now) {
+    sourceEntry *e = NULL;
+    sourceEntry *lru = &this->table[0];
+
+    for (int i = 0; i < SOURCE_STATS; i++) {
+        sourceEntry *t = &this->table[i];
+        if ((t->ip == ip) && (t->universe == universe) && (t->sacn == sacn)) {
+            e = t;
+            break;
+        }
+        if ((t->ip == 0) || ((lru->ip != 0) && ((now - t->lastSeen) > (now - lru->lastSeen)))) lru = t;
+    }
+    if (e == NULL) {
+        e = lru;
+        memset(e, 0, sizeof(sourceEntry));
+        e->ip = ip;
+        e->universe = universe;
+        e->sacn = sacn;
+        e->windowStart = now;
+    }
+
+    this->roll(e, now);
+    e->sequence = sequence;
+    e->packets++;
+    e->lastSeen = now;
+    e->windowPackets++;
+    e->windowBytes += bytes;
+}
+
+/*
+ * Add frames lost in front of the last packet recorded from ip for universe,
+ * the gap seqTracker::check() found for it
+ */
+void sourceStats::lost(uint32_t ip, uint16_t universe, bool sacn, uint8_t frames) {
+    for (int i = 0; i < SOURCE_STATS; i++) {
+        sourceEntry *e = &this->table[i];
+        if ((e->ip == ip) && (e->universe == universe) && (e->sacn == sacn)) {
+            e->lost += frames;
+            return;
+        }
+    }
+}
+
+/*
+ * Entry i with its rates brought up to date, NULL if it is free
+ */
+const sourceEntry *sourceStats::entry(int i, uint32_t now) {
+    if ((i < 0) || (i >= SOURCE_STATS) || (this->table[i].ip == 0)) return NULL;
+    this->roll(&this->table[i], now);
+    return &this->table[i];
+}
+
+int sourceStats::count() {
+    return SOURCE_STATS;
+}
+
+/*
+ * The table as a compact JSON array into buf, returns the length
+ * Entries that do not fit are left out
+ */
+int sourceStats::json(char *buf, size_t size, uint32_t now) {
+    size_t len = 0;
+    if (size < 3) return 0;
+    buf[len++] = '[';
+    for (int i = 0; i < SOURCE_STATS; i++) {
+        const sourceEntry *e = this->entry(i, now);
+        if (e == NULL) continue;
+        const uint8_t *ip = (const uint8_t *)&e->ip;
+        int n = snprintf(buf + len, size - len - 1,
+                         "%s{\"ip\":\"%u.%u.%u.%u\",\"proto\":\"%s\",\"universe\":%u,\"pps\":%u,\"bps\":%lu,"
+                         "\"packets\":%lu,\"seq\":%u,\"lost\":%lu,\"age\":%lu}",
+                         (len > 1) ? "," : "", ip[0], ip[1], ip[2], ip[3], e->sacn ? "sacn" : "artnet", e->universe,
+                         e->pps, (unsigned long)e->bps, (unsigned long)e->packets, e->sequence, (unsigned long)e->lost,
+                         (unsigned long)(now - e->lastSeen));
+        if ((n < 0) || ((size_t)n >= size - len - 1)) break;
+        len += n;
+    }
+    buf[len++] = ']';
+    buf[len] = 0;
+    return len;
+}
@@ -0,0 +1,52 @@
+/*
+ * Statistics per Art-Net/sACN sender
+ *
+ * A fixed table of senders keyed by source IP and universe, filled from the
+ * receive callbacks for every DMX packet, routed or not. When the table is
+ * full the least recently seen entry is replaced. Rates are counted over
+ * one second windows. Lost frames are not worked out here but taken from
+ * the sequence check (artnet_seq.h), so they are counted for routed
+ * universes only and agree with it on reordering and wraps.
+ */
+
+#ifndef _SOURCE_STATS_H_
+#define _SOURCE_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SOURCE_STATS 16           // senders in the table
+#define SOURCE_WINDOW 1000        // ms, rate measurement
+
+struct sourceEntry {
+    uint32_t ip;              // IPv4 address, network order, 0 for a free entry
+    uint16_t universe;        // Port-Address
+    uint8_t sacn;             // 1 for sACN, 0 for Art-Net
+    uint8_t sequence;         // last sequence
+    uint32_t packets;
+    uint32_t lost;            // frames lost, as the sequence check found
+    uint32_t lastSeen;        // ms
+    uint32_t windowStart;
+    uint16_t windowPackets;
+    uint32_t windowBytes;
+    uint16_t pps;             // packets/s in the last complete window
+    uint32_t bps;             // bytes/s in the last complete window
+};
+
+class sourceStats {
+    public:
+        sourceStats();
+
+        void record(uint32_t ip, uint16_t universe, bool sacn, uint8_t sequence, uint16_t bytes, uint32_t now);
+        void lost(uint32_t ip, uint16_t universe, bool sacn, uint8_t frames);
+        const sourceEntry *entry(int i, uint32_t now);
+        int count();
+        int json(char *buf, size_t size, uint32_t now);
+
+    private:
+        sourceEntry table[SOURCE_STATS];
+
+        void roll(sourceEntry *e, uint32_t now);
+};
+
+#endif
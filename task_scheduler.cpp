@@ -0,0 +1,180 @@
+/*
+ * Cooperative scheduler for loop()
+ */
+
+#include <stddef.h>
+#include "task_scheduler.h"
+#ifdef ARDUINO
+#include <coredecls.h>        // esp_schedule()
+#endif
+
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+// a is before b, on a wrapping clock
+static inline bool before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+taskScheduler::taskScheduler(uint32_t (*clock)(void)) {
+    this->clock = clock;
+    this->tasks = 0;
+    this->jobs = 0;
+    for (int i = 0; i < WHEEL_SLOTS; i++) this->wheel[i] = -1;
+    this->tick = 0;
+    this->wakeup = false;
+    this->inTasks = false;
+    this->runCount = 0;
+    this->deferCount = 0;
+}
+
+/*
+ * Add a high priority task, run every period ms (0 = every pass)
+ */
+bool taskScheduler::addTask(schedFn fn, uint32_t period) {
+    if (this->tasks >= SCHED_TASKS) return false;
+    this->task[this->tasks].fn = fn;
+    this->task[this->tasks].period = period;
+    this->task[this->tasks].due = this->clock();
+    this->tasks++;
+    return true;
+}
+
+/*
+ * Add a housekeeping job, run every interval ms
+ */
+bool taskScheduler::addJob(schedFn fn, uint32_t interval) {
+    if (this->jobs >= SCHED_JOBS) return false;
+    if (this->jobs == 0) {
+        this->tick = this->clock();
+        this->tick -= this->tick % WHEEL_TICK;
+    }
+    int j = this->jobs++;
+    this->job[j].fn = fn;
+    this->job[j].interval = interval;
+    this->job[j].due = this->clock() + interval;
+    this->insert(j);
+    return true;
+}
+
+/*
+ * Put job j into the slot of its due time
+ * Jobs due more than one turn of the wheel ahead wait there for later turns
+ */
+void taskScheduler::insert(int j) {
+    int slot = (this->job[j].due / WHEEL_TICK) & WHEEL_MASK;
+    this->job[j].next = this->wheel[slot];
+    this->wheel[slot] = j;
+}
+
+void taskScheduler::unlink(int slot, int j) {
+    int8_t *p = &this->wheel[slot];
+    while (*p != j) p = &this->job[*p].next;
+    *p = this->job[j].next;
+}
+
+uint32_t taskScheduler::nextTaskDue() {
+    uint32_t now = this->clock();
+    uint32_t next = now + SCHED_SLEEP_MAX;
+    for (int i = 0; i < this->tasks; i++) {
+        if (before(this->task[i].due, next)) next = this->task[i].due;
+    }
+    return next;
+}
+
+uint32_t taskScheduler::nextDue() {
+    uint32_t next = this->nextTaskDue();
+    for (int j = 0; j < this->jobs; j++) {
+        if (before(this->job[j].due, next)) next = this->job[j].due;
+    }
+    return next;
+}
+
+/*
+ * Run the tasks that are due, or were woken
+ * Long jobs call this between their work units, so a due frame is never
+ * held up by them. Does nothing when called from a task.
+ */
+void taskScheduler::runTasks() {
+    if (this->inTasks) return;
+    this->inTasks = true;
+    bool woken = this->wakeup;
+    this->wakeup = false;
+    uint32_t now = this->clock();
+    for (int i = 0; i < this->tasks; i++) {
+        schedTask *t = &this->task[i];
+        if (!woken && before(now, t->due)) continue;
+        t->fn();
+        t->due = (before(now, t->due)) ? t->due : t->due + t->period;
+        if (before(t->due, now)) t->due = now + t->period;   // fell behind, no catching up
+    }
+    this->inTasks = false;
+}
+
+/*
+ * One pass: due tasks, then jobs until the next task deadline
+ * Returns the ms until the next deadline, the time loop() may sleep
+ */
+uint32_t taskScheduler::runOnce() {
+    this->runTasks();
+    uint32_t now;
+
+    // walk the wheel up to now, a slot is only left when all its due jobs ran
+    uint32_t deadline = this->nextTaskDue();
+    bool first = true;
+    uint32_t nowTick = this->clock();
+    nowTick -= nowTick % WHEEL_TICK;
+    while (!before(nowTick, this->tick)) {
+        int slot = (this->tick / WHEEL_TICK) & WHEEL_MASK;
+        int j = this->wheel[slot];
+        while (j >= 0) {
+            int next = this->job[j].next;
+            now = this->clock();
+            if (!before(now, this->job[j].due)) {
+                if (!first && !before(now, deadline)) {
+                    this->deferCount++;
+                    return 0;   // tasks are due again, carry on next pass
+                }
+                first = false;
+                this->unlink(slot, j);
+                this->job[j].fn();
+                this->runCount++;
+                now = this->clock();
+                this->job[j].due += this->job[j].interval;
+                if (before(this->job[j].due, now)) this->job[j].due = now + this->job[j].interval;
+                this->insert(j);
+            }
+            j = next;
+        }
+        if (this->tick == nowTick) break;
+        this->tick += WHEEL_TICK;
+    }
+
+    now = this->clock();
+    uint32_t next = this->nextDue();
+    return before(now, next) ? next - now : 0;
+}
+
+/*
+ * End the sleep of loop() early, safe to call from callbacks
+ */
+void taskScheduler::wake() {
+    this->wakeup = true;
+#ifdef ARDUINO
+    esp_schedule();           // resume loop() out of esp_delay()
+#endif
+}
+
+bool taskScheduler::woken() {
+    return this->wakeup;
+}
+
+uint32_t taskScheduler::jobsRun() {
+    return this->runCount;
+}
+
+/*
+ * Passes where jobs were left for later because a task was due
+ */
+uint32_t taskScheduler::jobsDeferred() {
+    return this->deferCount;
+}
@@ -0,0 +1,75 @@
+/*
+ * Cooperative scheduler for loop()
+ *
+ * Two kinds of work:
+ * - tasks, high priority with a deadline every period (DMX output, Art-Net
+ *   intake). All due tasks run first on every pass.
+ * - jobs, housekeeping (LED, temperature, web, mDNS, status line, ...).
+ *   They sit in a hashed timer wheel and run in the time left until the
+ *   next task deadline, at least one job per pass so none starves.
+ * When nothing is due, loop() sleeps in esp_delay() until the next
+ * deadline, or until wake() is called, e.g. by a receive callback.
+ *
+ * The clock is passed to the constructor, so the schedule can be checked
+ * with a simulated clock on a host.
+ */
+
+#ifndef _TASK_SCHEDULER_H_
+#define _TASK_SCHEDULER_H_
+
+#include <stdint.h>
+
+#define SCHED_TASKS 4         // high priority tasks
+#define SCHED_JOBS 16         // housekeeping jobs
+#define WHEEL_SLOTS 16        // slots in the timer wheel, power of two
+#define WHEEL_TICK 4          // ms per slot
+#define SCHED_SLEEP_MAX 10    // ms, longest sleep
+
+typedef void (*schedFn)(void);
+
+struct schedTask {
+    schedFn fn;
+    uint32_t period;
+    uint32_t due;
+};
+
+struct schedJob {
+    schedFn fn;
+    uint32_t interval;
+    uint32_t due;
+    int8_t next;          // next job in the same wheel slot, -1 for none
+};
+
+class taskScheduler {
+    public:
+        taskScheduler(uint32_t (*clock)(void));
+
+        bool addTask(schedFn fn, uint32_t period);
+        bool addJob(schedFn fn, uint32_t interval);
+        uint32_t runOnce();
+        void runTasks();
+        void wake();
+        bool woken();
+        uint32_t jobsRun();
+        uint32_t jobsDeferred();
+
+    private:
+        uint32_t (*clock)(void);
+        schedTask task[SCHED_TASKS];
+        int tasks;
+        schedJob job[SCHED_JOBS];
+        int jobs;
+        int8_t wheel[WHEEL_SLOTS];   // first job of each slot
+        uint32_t tick;               // wheel position, start of its slot in ms, wraps with the clock
+        volatile bool wakeup;
+        bool inTasks;
+        uint32_t runCount;
+        uint32_t deferCount;
+
+        void insert(int j);
+        void unlink(int slot, int j);
+        uint32_t nextTaskDue();
+        uint32_t nextDue();
+};
+
+#endif
@@ -0,0 +1,52 @@
+/*
+ * Host benchmark of the /api/status serializer, see api_status.h
+ *
+ * Writes the document with every field at its longest, and its ETag,
+ * and checks that it fits API_STATUS_SIZE. Run with make -C tests bench.
+ * The time is for the host CPU, see /profile for the ESP8266.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "api_status.h"
+
+#define ROUNDS 200000
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+int main() {
+    static char json[API_STATUS_SIZE];
+    apiStatus s;
+    memset(&s, 0, sizeof(s));
+    s.status = "Not receiving any DMX, outputting last frame";
+    s.rssi = -100;
+    s.temperature = -40;
+    s.fanspeed = 1024;
+    s.artnetPackets = s.sacnPackets = s.matched = s.queued = 4294967295UL;
+    s.coalesced = s.dropped = s.lost = s.reordered = s.duplicates = 4294967295UL;
+    s.ports = 2;
+    s.universe[0] = s.universe[1] = 32767;
+    s.frames[0] = s.frames[1] = 4294967295UL;
+    s.fps = s.fpsShort = 4294967295UL;
+    s.jitterMax = -2147483647 - 1;
+    s.late = 4294967295UL;
+    s.artsync = s.merging = true;
+
+    volatile uint32_t sink = 0;
+    int len = 0;
+    double t = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        s.frames[0] = 4294967295UL - (r & 1);
+        len = apiStatusJson(&s, json, sizeof(json));
+        sink += apiEtag(json, len);
+    }
+    double us = (now() - t) / ROUNDS * 1e6;
+
+    printf("bench_api_status: longest document %d of %d bytes, with ETag %.2f us\n", len, API_STATUS_SIZE, us);
+    return (len > 0) && (len < API_STATUS_SIZE) ? 0 : 1;
+}
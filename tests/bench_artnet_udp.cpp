@@ -0,0 +1,63 @@
+/*
+ * Host benchmark of the Art-Net receive path, see artnet_udp.h
+ *
+ * A 512 channel ArtDmx through artnetUdp::receive() into the ring, in one
+ * pbuf and split over two, and one for a universe that is not routed,
+ * which stops after the header. Run with make -C tests bench. The numbers
+ * are for the host CPU, they only show the ratio.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "artnet_udp.h"
+
+#define ROUNDS 500000
+
+static uint8_t packet[ARTNET_HEADER + 512];
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static bool routed(uint16_t universe, uint32_t, uint8_t) {
+    return universe == 0;
+}
+
+static double run(artnetUdp *udp, artnetRing *ring, struct pbuf *p) {
+    double t = now();
+    for (int r = 0; r < ROUNDS; r++) {
+        packet[12] = r;
+        udp->receive(p, 0x0a00000a, r);
+        if (ring->front()) ring->pop();
+    }
+    return (now() - t) / ROUNDS * 1e9;
+}
+
+int main() {
+    memcpy(packet, "Art-Net", 8);
+    packet[9] = ARTNET_OP_DMX >> 8;
+    packet[11] = ARTNET_PROTOCOL;
+    packet[16] = 512 >> 8;
+    for (int i = 0; i < 512; i++) packet[ARTNET_HEADER + i] = i;
+
+    artnetRing ring;
+    ring.begin();
+    artnetUdp udp;
+    udp.begin(&ring);
+    udp.setDmxFilter(routed);
+
+    struct pbuf one = { NULL, packet, sizeof(packet), sizeof(packet) };
+    double whole = run(&udp, &ring, &one);
+    struct pbuf second = { NULL, packet + 300, sizeof(packet) - 300, sizeof(packet) - 300 };
+    struct pbuf first = { &second, packet, sizeof(packet), 300 };
+    double split = run(&udp, &ring, &first);
+    packet[14] = 1;
+    double skipped = run(&udp, &ring, &one);
+
+    printf("bench_artnet_udp: ArtDmx of 512 channels, one pbuf %.0f ns, chained %.0f ns, not routed %.0f ns\n",
+           whole, split, skipped);
+    return 0;
+}
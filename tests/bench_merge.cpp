@@ -0,0 +1,59 @@
+/*
+ * Host benchmark of the merge kernels, see dmx_merge.h
+ *
+ * Compares mergeHtp() and mergeLtp(), four channels per 32 bit word, with
+ * a plain loop over the channels. Run with make -C tests bench. Both are built without
+ * vectorisation, the ESP8266 has no vector unit. The numbers are for the
+ * host CPU, they only show the ratio.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "dmx_merge.h"
+#include "dmx_frames.h"
+
+#define ROUNDS 200000
+
+static uint32_t a[FRAME_SIZE / 4], b[FRAME_SIZE / 4], c[FRAME_SIZE / 4], out[FRAME_SIZE / 4];
+
+static void __attribute__((noinline)) mergeBytes(uint8_t *o, const uint8_t *x, const uint8_t *y, uint16_t length) {
+    for (int i = 0; i < length; i++) o[i] = (x[i] > y[i]) ? x[i] : y[i];
+}
+
+static void __attribute__((noinline)) ltpBytes(uint8_t *o, const uint8_t *c, const uint8_t *p, const uint8_t *n, uint16_t length) {
+    for (int i = 0; i < length; i++) o[i] = (p[i] != n[i]) ? n[i] : c[i];
+}
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+int main() {
+    uint8_t *pa = (uint8_t *)a, *pb = (uint8_t *)b, *pc = (uint8_t *)c, *po = (uint8_t *)out;
+    for (int i = 0; i < FRAME_SIZE; i++) { pa[i] = rand(); pb[i] = rand(); pc[i] = rand(); }
+    volatile uint8_t sink = 0;
+
+    double t = now();
+    for (int r = 0; r < ROUNDS; r++) { mergeHtp(po, pa, pb, FRAME_SIZE); pa[r & 511]++; sink += po[r & 511]; }
+    double word = (now() - t) / ROUNDS * 1e9;
+
+    t = now();
+    for (int r = 0; r < ROUNDS; r++) { mergeBytes(po, pa, pb, FRAME_SIZE); pa[r & 511]++; sink += po[r & 511]; }
+    double bytes = (now() - t) / ROUNDS * 1e9;
+
+    printf("bench_merge: HTP of 512 channels, word kernel %.0f ns, per channel %.0f ns\n", word, bytes);
+
+    t = now();
+    for (int r = 0; r < ROUNDS; r++) { mergeLtp(po, pc, pa, pb, FRAME_SIZE); pa[r & 511]++; sink += po[r & 511]; }
+    word = (now() - t) / ROUNDS * 1e9;
+
+    t = now();
+    for (int r = 0; r < ROUNDS; r++) { ltpBytes(po, pc, pa, pb, FRAME_SIZE); pa[r & 511]++; sink += po[r & 511]; }
+    bytes = (now() - t) / ROUNDS * 1e9;
+
+    printf("bench_merge: LTP of 512 channels, word kernel %.0f ns, per channel %.0f ns\n", word, bytes);
+    return 0;
+}
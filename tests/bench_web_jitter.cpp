@@ -0,0 +1,103 @@
+/*
+ * Host benchmark of the DMX output under web load, see
+ * engineering-notes/web-load.txt
+ *
+ * The scheduler of loop() runs on the simulated clock of the hardware
+ * model: port 1 by timer1, port 2 (I2S) refilled by its task every 5ms,
+ * 40 fps on both. A web job serves a page of PAGE_BYTES, every chunk of
+ * WEB_BUFFER bytes takes CHUNK_US to format and hand to TCP. Three runs:
+ * no web load, the page served in one go, and served by webWriter with
+ * the due tasks run between the chunks.
+ *
+ * Port 1 should not move in any run. An empty I2S ring delays every later
+ * frame of port 2 by the time it stays empty, that time is the result.
+ * Run with make -C tests bench.
+ */
+
+#include <stdio.h>
+#include "dmx_hw.h"
+#include "dmx_output.h"
+#include "dmx_i2s.h"
+#include "task_scheduler.h"
+
+#define PAGE_BYTES 12000      // about the config page
+#define CHUNK_BYTES 512       // WEB_BUFFER of web_writer.h
+#define CHUNK_US 1500         // format one chunk and hand it to TCP
+#define RUN_MS 10000
+
+static dmxOutput dmx(1);
+static dmxI2sOutput dmx2;
+static frameBuffer frames[2];
+static taskScheduler *sched;
+static bool load, sliced, running;
+static uint32_t emptyUs, emptyMax, emptyNow;
+
+static uint32_t clockMs() {
+    return dmxHostNow / 1000;
+}
+
+// let time pass, in steps of one I2S word
+static void spend(uint32_t us) {
+    while (us > 0) {
+        uint32_t step = (us > DMX_I2S_WORD_US) ? DMX_I2S_WORD_US : us;
+        dmxHostRun(step);
+        us -= step;
+        if (running && (dmxI2sQueued() == 0)) {
+            emptyUs += step;
+            emptyNow += step;
+            if (emptyNow > emptyMax) emptyMax = emptyNow;
+        } else {
+            emptyNow = 0;
+        }
+    }
+}
+
+static void taskDmx2() {
+    dmx2.handle();
+    spend(50);
+}
+
+static void jobWeb() {
+    if (!load) return;
+    for (int sent = 0; sent < PAGE_BYTES; sent += CHUNK_BYTES) {
+        spend(CHUNK_US);
+        if (sliced) sched->runTasks();
+    }
+}
+
+static void measure(const char *name, bool withLoad, bool withSlices) {
+    dmxHostReset();
+    for (int p = 0; p < 2; p++) frames[p].begin();
+    dmx.begin();
+    dmx2.begin(2);
+    dmx.run(&frames[0], 25000, DMX_SLOTS);
+    dmx2.run(&frames[1], 25000, DMX_SLOTS);
+    load = withLoad;
+    sliced = withSlices;
+    emptyUs = emptyMax = emptyNow = 0;
+
+    taskScheduler s(clockMs);
+    sched = &s;
+    s.addTask(taskDmx2, 5);
+    s.addJob(jobWeb, 5);
+    spend(50000);           // the mark begin() queued goes out first
+    running = true;
+    dmx.resetStats();
+    uint32_t end = dmxHostNow + RUN_MS * 1000;
+    while ((int32_t)(dmxHostNow - end) < 0) {
+        uint32_t idle = s.runOnce();
+        spend(idle ? idle * 1000 : 100);
+    }
+    running = false;
+
+    dmxFrameStats st = dmx.stats();
+    printf("bench_web_jitter: %-10s port 1 jitter %d..%d us, port 2 ring empty %u us, longest %u us\n",
+           name, (int)st.jitterMin, (int)st.jitterMax, emptyUs, emptyMax);
+}
+
+int main() {
+    measure("no load", false, false);
+    measure("one go", true, false);
+    measure("chunked", true, true);
+    return 0;
+}
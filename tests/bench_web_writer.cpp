@@ -0,0 +1,74 @@
+/*
+ * Host benchmark of webWriter against a page built in a String, see
+ * web_writer.h
+ *
+ * The same status page, 60 rows of text and numbers, is once assembled
+ * in a String and sent with one send(), as the pages were before, and
+ * once written through webWriter. Compared are the time to the first
+ * byte handed to the server and the lowest free heap, on the host
+ * stand-ins of tests/host: String grows by realloc to the exact length
+ * like the ESP8266 core. The times are for the host CPU, the heap
+ * figures carry over to the node. The writer takes no heap, its
+ * WEB_BUFFER lives in the global page object.
+ */
+
+#include <stdio.h>
+#include "Arduino.h"
+#include "ESP8266WebServer.h"
+#include "web_writer.h"
+
+#define ROWS 60
+#define ROUNDS 2000
+
+static ESP8266WebServer server;
+static webWriter page(server, NULL);
+
+static void pageString() {
+    String body;
+    body += F("<html><head><title>ESP-DMX</title></head><body><h1>Status</h1>\n<table>\n");
+    for (int row = 0; row < ROWS; row++) {
+        body += F("<tr><td>Artnet frames received on the universe of the port:</td><td>");
+        body += (unsigned long)(row * 40123);
+        body += F(" / ");
+        body += row;
+        body += F("</td></tr>\n");
+    }
+    body += F("</table>\n</body></html>\n");
+    server.send(200, "text/html", body);
+}
+
+static void pageWriter() {
+    page.begin(200, "text/html");
+    page.print(F("<html><head><title>ESP-DMX</title></head><body><h1>Status</h1>\n<table>\n"));
+    for (int row = 0; row < ROWS; row++) {
+        page.print(F("<tr><td>Artnet frames received on the universe of the port:</td><td>"));
+        page.print((unsigned long)(row * 40123));
+        page.print(F(" / "));
+        page.print(row);
+        page.print(F("</td></tr>\n"));
+    }
+    page.print(F("</table>\n</body></html>\n"));
+    page.end();
+}
+
+static void measure(const char *name, void (*fn)(void)) {
+    uint32_t firstByte = 0;
+    uint32_t total = 0;
+    uint32_t bytes = 0;
+    hostHeapPeak = hostHeapUsed;
+    for (int r = 0; r < ROUNDS; r++) {
+        hostServerStart(&server);
+        fn();
+        firstByte += server.firstByte;
+        total += micros() - server.started;
+        bytes = server.bytes;
+    }
+    printf("bench_web_writer: %-7s %5u bytes, first byte %4.1f us, total %4.1f us, heap taken %5u bytes\n",
+           name, bytes, (double)firstByte / ROUNDS, (double)total / ROUNDS, hostHeapPeak);
+}
+
+int main() {
+    measure("String", pageString);
+    measure("writer", pageWriter);
+    return 0;
+}
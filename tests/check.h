@@ -0,0 +1,25 @@
+/*
+ * Minimal checks for the host tests, see Makefile
+ */
+
+#ifndef _CHECK_H_
+#define _CHECK_H_
+
+#include <stdio.h>
+
+static int checkFailures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            checkFailures++; \
+        } \
+    } while (0)
+
+// end of main(), prints the result and gives the exit code
+static inline int checkDone(const char *name) {
+    printf("%s: %s\n", name, checkFailures ? "FAILED" : "ok");
+    return checkFailures ? 1 : 0;
+}
+
+#endif
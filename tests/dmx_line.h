@@ -0,0 +1,68 @@
+/*
+ * Decoder for the UART1 line timeline of the host model, see dmx_hw.h
+ */
+
+#ifndef _DMX_LINE_H_
+#define _DMX_LINE_H_
+
+#include "dmx_hw.h"
+
+// One frame as seen on the line, times in microseconds
+struct dmxLineFrame {
+    uint32_t breakStart;
+    uint32_t breakUs;
+    uint32_t mabUs;
+    int slots;                  // start code included, -1 on a framing error
+    uint8_t slot[513];
+};
+
+// Line level at time t
+static inline uint8_t dmxLineLevel(uint32_t t) {
+    uint8_t level = 1;
+    for (int i = 0; (i < dmxHostLineLen) && (dmxHostLine[i].t <= t); i++) level = dmxHostLine[i].level;
+    return level;
+}
+
+// Index of the first falling edge at or after t, -1 if none
+static inline int dmxLineFall(uint32_t t) {
+    for (int i = 0; i < dmxHostLineLen; i++) {
+        if ((dmxHostLine[i].t >= t) && (dmxHostLine[i].level == 0)) return i;
+    }
+    return -1;
+}
+
+/*
+ * Decode the frame whose break is the first falling edge at or after t
+ * A low longer than a slot is a break, the slots are sampled in the middle
+ * of each 4us bit. Returns the time after the frame, 0 if there is none.
+ */
+static inline uint32_t dmxLineDecode(uint32_t t, dmxLineFrame *f) {
+    int e = dmxLineFall(t);
+    if ((e < 0) || (e + 1 >= dmxHostLineLen)) return 0;
+    f->breakStart = dmxHostLine[e].t;
+    f->breakUs = dmxHostLine[e + 1].t - f->breakStart;
+    f->mabUs = 0;
+    f->slots = 0;
+    if (e + 2 >= dmxHostLineLen) return 0;
+    f->mabUs = dmxHostLine[e + 2].t - dmxHostLine[e + 1].t;
+
+    uint32_t start = dmxHostLine[e + 2].t;
+    while (f->slots < 513) {
+        uint8_t b = 0;
+        for (int i = 0; i < 8; i++) b |= dmxLineLevel(start + DMX_BIT_US * (i + 1) + DMX_BIT_US / 2) << i;
+        if (!dmxLineLevel(start + DMX_BIT_US * 9 + DMX_BIT_US / 2) || !dmxLineLevel(start + DMX_BIT_US * 10 + DMX_BIT_US / 2)) {
+            f->slots = -1;
+            return start + DMX_SLOT_US;
+        }
+        f->slot[f->slots++] = b;
+        // the next slot follows within a slot time, anything later is the next break
+        int n = dmxLineFall(start + DMX_SLOT_US);
+        if ((n < 0) || (dmxHostLine[n].t > start + 2 * DMX_SLOT_US)) break;
+        uint32_t next = dmxHostLine[n].t;
+        if ((n + 1 < dmxHostLineLen) && (dmxHostLine[n + 1].t - next > DMX_SLOT_US)) break;   // a break
+        start = next;
+    }
+    return start + DMX_SLOT_US;
+}
+
+#endif
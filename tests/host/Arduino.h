@@ -0,0 +1,108 @@
+/*
+ * Stand-in for the parts of Arduino.h the web modules use, host only
+ *
+ * millis() is a simulated clock, the test sets hostMillis. Serial prints
+ * to stdout. String and the heap figure of ESP follow the ESP8266 core closely
+ * enough to compare heap use: String grows its buffer to the exact
+ * length, holding the old buffer while copying, every allocation
+ * through hostMalloc() counts against HOST_HEAP.
+ */
+
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_HEAP 40000           // free heap of the node with wifi up
+
+typedef const char *PGM_P;
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define strlen_P strlen
+#define memcpy_P memcpy
+
+template <typename T> static inline T min(T a, T b) { return (a < b) ? a : b; }
+
+uint32_t micros();
+uint32_t millis();
+extern uint32_t hostMillis;
+void *hostMalloc(size_t size);
+void hostFree(void *p, size_t size);
+extern uint32_t hostHeapUsed;
+extern uint32_t hostHeapPeak;         // most heap in use at once
+
+class EspClass {
+    public:
+        uint32_t getFreeHeap() { return HOST_HEAP - hostHeapUsed; }
+};
+extern EspClass ESP;
+
+class String {
+    public:
+        String(const char *s = "");
+        String(const String &s);
+        ~String();
+        String &operator=(const String &s);
+        String &operator+=(const char *s);
+        String &operator+=(const __FlashStringHelper *s);
+        String &operator+=(const String &s);
+        String &operator+=(char c);
+        String &operator+=(int n);
+        String &operator+=(unsigned int n);
+        String &operator+=(long n);
+        String &operator+=(unsigned long n);
+        bool operator==(const char *s) const { return strcmp(this->c_str(), s) == 0; }
+        bool operator==(const String &s) const { return strcmp(this->c_str(), s.c_str()) == 0; }
+        bool startsWith(const char *s) const { return strncmp(this->c_str(), s, strlen(s)) == 0; }
+        int indexOf(char c, unsigned int from = 0) const;
+        String substring(unsigned int from, unsigned int to = (unsigned int)-1) const;
+        long toInt() const { return atol(this->c_str()); }
+        void remove(unsigned int index);
+        const char *c_str() const { return this->buffer ? this->buffer : ""; }
+        unsigned int length() const { return this->len; }
+
+    private:
+        char *buffer;
+        unsigned int capacity;
+        unsigned int len;
+
+        void append(const char *s, unsigned int n);
+};
+
+class Print {
+    public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t *data, size_t len);
+        size_t print(const char *s) { return this->write((const uint8_t *)s, strlen(s)); }
+        size_t print(const String &s) { return this->write((const uint8_t *)s.c_str(), s.length()); }
+        size_t print(const __FlashStringHelper *s) { return this->print(reinterpret_cast<const char *>(s)); }
+        size_t print(char c) { return this->write((uint8_t)c); }
+        size_t print(int n) { return this->number(n); }
+        size_t print(unsigned int n) { return this->number(n); }
+        size_t print(long n) { return this->number(n); }
+        size_t print(unsigned long n) { return this->number(n); }
+
+    private:
+        size_t number(long long n) {
+            char text[24];
+            int len = snprintf(text, sizeof(text), "%lld", n);
+            return this->write((const uint8_t *)text, len);
+        }
+};
+
+class HardwareSerial : public Print {
+    public:
+        size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+        size_t println(const char *s) { return this->print(s) + this->print('\n'); }
+        size_t println(const String &s) { return this->println(s.c_str()); }
+        size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Stand-in for ESP8266WebServer, host only
+ *
+ * Records what a handler hands over: bytes, calls and the time of the
+ * first byte after the handler started, see hostServerStart().
+ */
+
+#ifndef _HOST_ESP8266WEBSERVER_H_
+#define _HOST_ESP8266WEBSERVER_H_
+
+#include "Arduino.h"
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+class ESP8266WebServer {
+    public:
+        ESP8266WebServer();
+
+        void setContentLength(size_t length);
+        void send(int code, const char *type, const String &content);
+        void sendContent(const char *content, size_t length);
+        void sendContent(const String &content);
+        void sendContent_P(PGM_P content, size_t length);
+        String uri();
+
+        uint32_t bytes;           // content handed over
+        uint32_t calls;
+        uint32_t started;         // us, the handler started
+        uint32_t firstByte;       // us after started, valid once bytes > 0
+
+    private:
+        bool chunked;
+
+        void content(const char *content, size_t length);
+};
+
+void hostServerStart(ESP8266WebServer *server);
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ * Stand-in for WiFiClient, host only
+ *
+ * All connections go to one simulated server, hostNet. Once the request
+ * is written the server's serve() makes the answer, which is handed out
+ * hostNet.piece bytes per read. The server then closes the connection,
+ * unless hostNet.hold keeps it open, and hostNet.cut bytes at the end of
+ * the answer are lost on the way.
+ */
+
+#ifndef _HOST_WIFICLIENT_H_
+#define _HOST_WIFICLIENT_H_
+
+#include "Arduino.h"
+
+#define HOST_ANSWER_MAX 4096
+
+struct hostServer {
+    bool reachable;           // takes TCP connections
+    const char *down;         // a host that does not, NULL for none
+    int mfln;                 // smallest TLS fragment length accepted, 0 for no MFLN support
+    bool hold;                // keep the connection open after the answer
+    int cut;                  // bytes of the answer never sent
+    int piece;                // bytes per read at most
+    int (*serve)(const char *request, char *answer, size_t size);
+    uint32_t connects;        // successful connects
+    uint32_t probes;          // fragment length probes
+    uint32_t resumed;         // TLS connects that resumed a session
+    uint16_t rxBuffer;        // receive buffer of the last TLS client
+};
+extern hostServer hostNet;
+
+bool hostReachable(const char *host);
+
+class WiFiClient {
+    public:
+        WiFiClient();
+        virtual ~WiFiClient() {}
+
+        void setTimeout(uint32_t timeout) { this->timeout = timeout; }
+        int connect(const char *host, uint16_t port);
+        size_t write(const uint8_t *data, size_t length);
+        int available();
+        int read(uint8_t *data, size_t length);
+        uint8_t connected();
+        void stop();
+
+    private:
+        uint32_t timeout;
+        bool open;
+        char request[512];
+        int requestLength;
+        char answer[HOST_ANSWER_MAX];
+        int answerLength;         // -1 until the request is complete
+        int at;
+};
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * Stand-in for the BearSSL client, host only
+ *
+ * No TLS, the connection is the plain one of WiFiClient.h. It records what
+ * the node sets up: the receive buffer, whether a session was resumed, and
+ * answers fragment length probes from hostNet.mfln.
+ */
+
+#ifndef _HOST_WIFICLIENTSECUREBEARSSL_H_
+#define _HOST_WIFICLIENTSECUREBEARSSL_H_
+
+#include "WiFiClient.h"
+
+namespace BearSSL {
+
+class Session {
+    public:
+        Session() { this->valid = false; }
+        bool valid;               // a handshake filled it in
+};
+
+class WiFiClientSecure : public WiFiClient {
+    public:
+        WiFiClientSecure() { this->session = NULL; }
+
+        void setInsecure() {}
+        void setBufferSizes(int rx, int) { hostNet.rxBuffer = rx; }
+        void setSession(Session *session) { this->session = session; }
+        int connect(const char *host, uint16_t port);
+        int getLastSSLError(char *text, size_t size);
+        static bool probeMaxFragmentLength(const String &host, uint16_t port, uint16_t length);
+
+    private:
+        Session *session;
+};
+
+}
+
+#endif
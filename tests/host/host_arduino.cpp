@@ -0,0 +1,160 @@
+/*
+ * Stand-in for the parts of the Arduino core the web modules use, host only
+ */
+
+#include <time.h>
+#include "Arduino.h"
+#include "ESP8266WebServer.h"
+
+EspClass ESP;
+HardwareSerial Serial;
+uint32_t hostMillis = 0;
+uint32_t hostHeapUsed = 0;
+uint32_t hostHeapPeak = 0;
+
+uint32_t micros() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint32_t)(t.tv_sec * 1000000ULL + t.tv_nsec / 1000);
+}
+
+uint32_t millis() {
+    return hostMillis;
+}
+
+void *hostMalloc(size_t size) {
+    hostHeapUsed += size;
+    if (hostHeapUsed > hostHeapPeak) hostHeapPeak = hostHeapUsed;
+    return malloc(size);
+}
+
+void hostFree(void *p, size_t size) {
+    if (p == NULL) return;
+    hostHeapUsed -= size;
+    free(p);
+}
+
+String::String(const char *s) {
+    this->buffer = NULL;
+    this->capacity = 0;
+    this->len = 0;
+    this->append(s, strlen(s));
+}
+
+String::String(const String &s) {
+    this->buffer = NULL;
+    this->capacity = 0;
+    this->len = 0;
+    this->append(s.c_str(), s.length());
+}
+
+String::~String() {
+    hostFree(this->buffer, this->capacity + 1);
+}
+
+String &String::operator=(const String &s) {
+    if (this == &s) return *this;
+    this->len = 0;
+    this->append(s.c_str(), s.length());
+    return *this;
+}
+
+// grows to the exact length like the core, the old buffer is held while copying
+void String::append(const char *s, unsigned int n) {
+    if (this->len + n > this->capacity) {
+        unsigned int capacity = this->len + n;
+        char *grown = (char *)hostMalloc(capacity + 1);
+        if (this->buffer) memcpy(grown, this->buffer, this->len);
+        hostFree(this->buffer, this->capacity + 1);
+        this->buffer = grown;
+        this->capacity = capacity;
+    }
+    if (this->buffer == NULL) return;
+    memcpy(this->buffer + this->len, s, n);
+    this->len += n;
+    this->buffer[this->len] = 0;
+}
+
+String &String::operator+=(const char *s) { this->append(s, strlen(s)); return *this; }
+String &String::operator+=(const __FlashStringHelper *s) { return *this += reinterpret_cast<const char *>(s); }
+String &String::operator+=(const String &s) { this->append(s.c_str(), s.length()); return *this; }
+String &String::operator+=(char c) { this->append(&c, 1); return *this; }
+String &String::operator+=(int n) { return *this += (long)n; }
+String &String::operator+=(unsigned int n) { return *this += (unsigned long)n; }
+String &String::operator+=(long n) { char t[24]; snprintf(t, sizeof(t), "%ld", n); return *this += t; }
+String &String::operator+=(unsigned long n) { char t[24]; snprintf(t, sizeof(t), "%lu", n); return *this += t; }
+
+int String::indexOf(char c, unsigned int from) const {
+    if (from >= this->len) return -1;
+    const char *p = strchr(this->c_str() + from, c);
+    return p ? p - this->c_str() : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (to > this->len) to = this->len;
+    String s;
+    if (from < to) s.append(this->c_str() + from, to - from);
+    return s;
+}
+
+void String::remove(unsigned int index) {
+    if (index >= this->len) return;
+    this->len = index;
+    this->buffer[index] = 0;
+}
+
+size_t HardwareSerial::printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return (n < 0) ? 0 : n;
+}
+
+size_t Print::write(const uint8_t *data, size_t len) {
+    for (size_t i = 0; i < len; i++) this->write(data[i]);
+    return len;
+}
+
+ESP8266WebServer::ESP8266WebServer() {
+    this->chunked = false;
+    hostServerStart(this);
+}
+
+void hostServerStart(ESP8266WebServer *server) {
+    server->bytes = 0;
+    server->calls = 0;
+    server->started = micros();
+    server->firstByte = 0;
+}
+
+void ESP8266WebServer::setContentLength(size_t length) {
+    this->chunked = (length == CONTENT_LENGTH_UNKNOWN);
+}
+
+void ESP8266WebServer::send(int, const char *, const String &content) {
+    this->content(content.c_str(), content.length());
+}
+
+void ESP8266WebServer::sendContent(const char *content, size_t length) {
+    this->content(content, length);
+}
+
+void ESP8266WebServer::sendContent(const String &content) {
+    this->content(content.c_str(), content.length());
+}
+
+void ESP8266WebServer::sendContent_P(PGM_P content, size_t length) {
+    this->content(content, length);
+}
+
+void ESP8266WebServer::content(const char *, size_t length) {
+    this->calls++;
+    if (length == 0) return;
+    if (this->bytes == 0) this->firstByte = micros() - this->started;
+    this->bytes += length;
+}
+
+String ESP8266WebServer::uri() {
+    return String("/");
+}
@@ -0,0 +1,93 @@
+/*
+ * Stand-in for the WiFi clients, host only
+ */
+
+#include "WiFiClient.h"
+#include "WiFiClientSecureBearSSL.h"
+
+hostServer hostNet;
+
+bool hostReachable(const char *host) {
+    return hostNet.reachable && ((hostNet.down == NULL) || (strcmp(host, hostNet.down) != 0));
+}
+
+WiFiClient::WiFiClient() {
+    this->timeout = 1000;
+    this->open = false;
+    this->requestLength = 0;
+    this->answerLength = -1;
+    this->at = 0;
+}
+
+int WiFiClient::connect(const char *host, uint16_t) {
+    this->stop();
+    if (!hostReachable(host)) return 0;
+    this->open = true;
+    hostNet.connects++;
+    return 1;
+}
+
+// the answer is made once the head of the request is in
+size_t WiFiClient::write(const uint8_t *data, size_t length) {
+    if (!this->open) return 0;
+    size_t n = min(length, sizeof(this->request) - 1 - this->requestLength);
+    memcpy(this->request + this->requestLength, data, n);
+    this->requestLength += n;
+    this->request[this->requestLength] = 0;
+    if ((this->answerLength < 0) && strstr(this->request, "\r\n\r\n")) {
+        int length = hostNet.serve ? hostNet.serve(this->request, this->answer, sizeof(this->answer)) : 0;
+        this->answerLength = (length > hostNet.cut) ? length - hostNet.cut : 0;
+        this->at = 0;
+    }
+    return n;
+}
+
+int WiFiClient::available() {
+    if (!this->open || (this->answerLength < 0)) return 0;
+    int left = this->answerLength - this->at;
+    return (hostNet.piece > 0) ? min(left, hostNet.piece) : left;
+}
+
+int WiFiClient::read(uint8_t *data, size_t length) {
+    int n = min((int)length, this->available());
+    memcpy(data, this->answer + this->at, n);
+    this->at += n;
+    return n;
+}
+
+// the server closes once its answer is out, unless hostNet.hold
+uint8_t WiFiClient::connected() {
+    if (!this->open) return 0;
+    if (this->available() > 0) return 1;
+    return hostNet.hold || (this->answerLength < 0);
+}
+
+void WiFiClient::stop() {
+    this->open = false;
+    this->requestLength = 0;
+    this->answerLength = -1;
+    this->at = 0;
+}
+
+namespace BearSSL {
+
+int WiFiClientSecure::connect(const char *host, uint16_t port) {
+    if (!WiFiClient::connect(host, port)) return 0;
+    if (this->session) {
+        if (this->session->valid) hostNet.resumed++;
+        this->session->valid = true;
+    }
+    return 1;
+}
+
+int WiFiClientSecure::getLastSSLError(char *text, size_t size) {
+    if (size > 0) text[0] = 0;
+    return 0;
+}
+
+bool WiFiClientSecure::probeMaxFragmentLength(const String &host, uint16_t, uint16_t length) {
+    hostNet.probes++;
+    return hostReachable(host.c_str()) && (hostNet.mfln > 0) && (length >= hostNet.mfln);
+}
+
+}
@@ -0,0 +1,50 @@
+/*
+ * Host test of the ArtPollReply, see artnet_pollreply.h
+ */
+
+#include <string.h>
+#include "check.h"
+#include "artnet_pollreply.h"
+
+int main() {
+    const uint8_t ip[4] = { 2, 0, 0, 10 };
+    const uint8_t mac[6] = { 1, 2, 3, 4, 5, 6 };
+    artnetPollReply r;
+    r.begin(ip, mac, 1, 2);
+
+    // both ports in Net 0 Sub 1, one reply with two ports
+    uint16_t same[2] = { 0x0010, 0x0013 };
+    r.setPorts(2, same);
+    r.setGoodOutput(0, 0x80);
+    r.setGoodOutput(1, 0x00);
+    CHECK(r.replies() == 1);
+    const uint8_t *p = r.next(0);
+    CHECK(p[173] == 2);
+    CHECK(p[18] == 0 && p[19] == 1);
+    CHECK(p[190] == 0 && p[191] == 3);
+    CHECK(p[182] == 0x80 && p[183] == 0x00);
+    CHECK(p[211] == 1);
+
+    // port 2 on another Net/Sub, one reply per port with its own BindIndex
+    uint16_t differ[2] = { 0x0010, 0x0125 };
+    r.setPorts(2, differ);
+    r.setGoodOutput(1, 0x88);
+    CHECK(r.replies() == 2);
+    p = r.next(0);
+    CHECK(p[173] == 1);
+    CHECK(p[18] == 0 && p[19] == 1 && p[190] == 0);
+    CHECK(p[182] == 0x80 && p[183] == 0x00 && p[175] == 0x00);
+    CHECK(p[211] == 1);
+    p = r.next(1);
+    CHECK(p[173] == 1);
+    CHECK(p[18] == 1 && p[19] == 2 && p[190] == 5);
+    CHECK(p[182] == 0x88 && p[183] == 0x00);
+    CHECK(p[211] == 2);
+    CHECK(p[207] == 2 && p[210] == 10);     // BindIp is the root device
+    CHECK(r.sent() == 3);
+
+    // the NodeReport counter goes up with every reply
+    CHECK(memcmp(&p[108], "#0001 [0003] OK", 16) == 0);
+
+    return checkDone("test_artnet_pollreply");
+}
@@ -0,0 +1,138 @@
+/*
+ * Host test of ArtSync with a simulated clock, see artnet_sync.h
+ *
+ * Staged frames are only released by an ArtSync, without ArtSync the node
+ * falls back to free running after the timeout. The I2S port must start
+ * the synced frame within the rest of the current frame plus the
+ * lookahead of the DMA ring, see dmx_i2s.h. Only the controller that sent
+ * the staged frames releases them.
+ */
+
+#include <string.h>
+#include "check.h"
+#include "artnet_sync.h"
+#include "dmx_hw.h"
+#include "dmx_i2s.h"
+
+#define CONTROLLER 0x0a00000aUL
+#define OTHER      0x0b00000aUL
+
+// index in the I2S log of the first frame start at or after from, -1 if none
+static int frameStart(int from) {
+    for (int i = from; i < dmxHostI2sLen; i++) {
+        if ((dmxHostI2s[i] != DMX_I2S_IDLE) && ((i == 0) || (dmxHostI2s[i - 1] == DMX_I2S_IDLE)) && !(dmxHostI2s[i] & 0x80000000UL)) return i;
+    }
+    return -1;
+}
+
+// words from a sync() until its frame is on the line, the I2S task runs every 5ms
+static int syncDelay(dmxI2sOutput *dmx2) {
+    int logged = dmxHostI2sLen;
+    int queued = dmxHostI2sQueued;
+    dmx2->sync();
+    for (int i = 0; i < 40; i++) {
+        dmx2->handle();
+        dmxHostRun(5000);
+    }
+    int start = frameStart(logged);
+    if (start < 0) return -1;
+    return queued + (start - logged);
+}
+
+int main() {
+    artnetSync sync;
+    uint32_t now = 1000;
+
+    // no ArtSync seen, frames are published as they come
+    CHECK(!sync.active(now));
+    CHECK(sync.commit(now) == 0);
+
+    // with ArtSync frames are staged until the next one
+    // handleArtnet() commits on every pass
+    sync.received(now, CONTROLLER);
+    CHECK(sync.commit(now) == 0);
+    CHECK(sync.active(now + 10));
+    sync.stage(0, CONTROLLER);
+    sync.stage(1, CONTROLLER);
+    CHECK(!sync.due());
+    CHECK(sync.commit(now + 20) == 0);
+    sync.received(now + 25, CONTROLLER);
+    CHECK(sync.commit(now + 25) == 3);
+    CHECK(sync.commit(now + 26) == 0);
+    CHECK(sync.syncs() == 2);
+
+    // a sync with nothing staged publishes nothing
+    sync.received(now + 50, CONTROLLER);
+    CHECK(sync.commit(now + 50) == 0);
+
+    // ArtSync stops, a staged frame goes out after the timeout
+    sync.stage(1, CONTROLLER);
+    CHECK(sync.commit(now + 50 + ARTSYNC_TIMEOUT) == 0);
+    CHECK(sync.active(now + 50 + ARTSYNC_TIMEOUT));
+    CHECK(sync.commit(now + 51 + ARTSYNC_TIMEOUT) == 2);
+    CHECK(!sync.active(now + 52 + ARTSYNC_TIMEOUT));
+
+    // an ArtSync from another controller releases nothing
+    sync.received(now + 100 + ARTSYNC_TIMEOUT, CONTROLLER);
+    CHECK(sync.commit(now + 100 + ARTSYNC_TIMEOUT) == 0);
+    sync.stage(0, CONTROLLER);
+    CHECK(!sync.received(now + 110 + ARTSYNC_TIMEOUT, OTHER));
+    CHECK(sync.commit(now + 110 + ARTSYNC_TIMEOUT) == 0);
+    CHECK(sync.received(now + 120 + ARTSYNC_TIMEOUT, CONTROLLER));
+    CHECK(sync.commit(now + 120 + ARTSYNC_TIMEOUT) == 1);
+
+    // the millisecond clock wraps
+    now = 0xffffff00UL;
+    sync.received(now, CONTROLLER);
+    CHECK(sync.active(now + 0x200));
+    sync.stage(0, CONTROLLER);
+    sync.received(now + 0x200, CONTROLLER);
+    CHECK(sync.commit(now + 0x200) == 1);
+
+    // I2S port: a slow period, only sync() starts frames
+    dmxHostReset();
+    frameBuffer frames;
+    frames.begin();
+    frames.back()->length = DMX_SLOTS;
+    frames.publish();
+    dmxI2sOutput dmx2;
+    dmx2.begin(2);
+    CHECK(dmxHostI2sQueued <= DMX_I2S_LOOKAHEAD);
+    dmx2.run(&frames, 1000000, DMX_SLOTS);
+    dmxHostRun(100000);
+    dmx2.handle();
+    CHECK(dmx2.frames() == 0);
+
+    // from idle the frame waits for the lookahead only
+    int delay = syncDelay(&dmx2);
+    CHECK(dmx2.frames() == 1);
+    CHECK(delay >= 0 && delay <= DMX_I2S_LOOKAHEAD);
+
+    // during a frame it also waits for the rest of that frame
+    dmxHostReset();
+    dmxI2sOutput dmx3;
+    dmx3.begin(2);
+    dmx3.run(&frames, 1000000, DMX_SLOTS);
+    dmx3.sync();
+    dmxHostRun(5000);
+    dmx3.handle();
+    CHECK(dmx3.frames() == 1);
+    // frame 2 follows frame 1 without mark in between
+    static uint32_t words[DMX_I2S_FRAME_WORDS];
+    int frameWords = dmxI2sEncode(frames.latest()->data, DMX_SLOTS, breakTime(), mabTime(), words, DMX_I2S_FRAME_WORDS);
+    int first = frameStart(0);
+    int logged = dmxHostI2sLen;
+    int queued = dmxHostI2sQueued;
+    dmx3.sync();
+    for (int i = 0; i < 40; i++) {
+        dmx3.handle();
+        dmxHostRun(5000);
+    }
+    CHECK(dmx3.frames() == 2);
+    CHECK(memcmp(dmxHostI2s + first + frameWords, words, frameWords * sizeof(uint32_t)) == 0);
+    delay = queued + (first + frameWords - logged);
+    CHECK(delay > DMX_I2S_LOOKAHEAD / 2);
+    CHECK(delay <= DMX_I2S_LOOKAHEAD + frameWords);
+
+    return checkDone("test_artnet_sync");
+}
@@ -0,0 +1,118 @@
+/*
+ * Host test of the Art-Net receiver, see artnet_udp.h
+ *
+ * Packets go through the pbuf of the host build: header checks of
+ * artnetParse(), the filter that keeps the payload of a universe that is
+ * not routed out of the ring, and payloads split over a pbuf chain.
+ */
+
+#include <string.h>
+#include "check.h"
+#include "artnet_udp.h"
+
+static uint8_t packet[ARTNET_HEADER + 512];
+
+// ArtDmx of length channels, channel i is i + 1
+static uint16_t artDmx(uint16_t universe, uint16_t length, uint8_t sequence) {
+    memset(packet, 0, sizeof(packet));
+    memcpy(packet, "Art-Net", 8);
+    packet[8] = ARTNET_OP_DMX & 0xff;
+    packet[9] = ARTNET_OP_DMX >> 8;
+    packet[11] = ARTNET_PROTOCOL;
+    packet[12] = sequence;
+    packet[14] = universe & 0xff;
+    packet[15] = universe >> 8;
+    packet[16] = length >> 8;
+    packet[17] = length & 0xff;
+    for (int i = 0; i < length; i++) packet[ARTNET_HEADER + i] = i + 1;
+    return ARTNET_HEADER + length;
+}
+
+static uint16_t wanted;
+static int filtered;
+
+static bool filter(uint16_t universe, uint32_t, uint8_t) {
+    filtered++;
+    return universe == wanted;
+}
+
+int main() {
+    artnetDmx dmx;
+
+    // header checks
+    uint16_t len = artDmx(0x0123, 512, 7);
+    CHECK(artnetParse(packet, len, &dmx) == ARTNET_OP_DMX);
+    CHECK(dmx.universe == 0x0123 && dmx.length == 512 && dmx.sequence == 7);
+    packet[3] = 'n';
+    CHECK(artnetParse(packet, len, &dmx) == 0);
+    len = artDmx(0x7fff, 512, 0);
+    CHECK(artnetParse(packet, len, &dmx) == ARTNET_OP_DMX && dmx.universe == 0x7fff);
+    packet[15] = 0xff;      // bit 15 is not part of the Port-Address
+    CHECK(artnetParse(packet, len, &dmx) == ARTNET_OP_DMX && dmx.universe == 0x7fff);
+    packet[11] = ARTNET_PROTOCOL - 1;
+    CHECK(artnetParse(packet, len, &dmx) == 0);
+    packet[11] = ARTNET_PROTOCOL;
+    packet[8] = 0x00;
+    packet[9] = 0x20;
+    CHECK(artnetParse(packet, 14, &dmx) == ARTNET_OP_POLL);
+    CHECK(artnetParse(packet, 9, &dmx) == 0);
+
+    // lengths: odd ones are taken as sent, too short or beyond the datagram not
+    len = artDmx(1, 3, 0);
+    CHECK(artnetParse(packet, len, &dmx) == ARTNET_OP_DMX && dmx.length == 3);
+    len = artDmx(1, 1, 0);
+    CHECK(artnetParse(packet, len, &dmx) == 0);
+    len = artDmx(1, 513, 0);
+    CHECK(artnetParse(packet, sizeof(packet), &dmx) == 0);
+    len = artDmx(1, 512, 0);
+    CHECK(artnetParse(packet, len - 1, &dmx) == 0);
+    CHECK(artnetParse(packet, ARTNET_HEADER - 1, &dmx) == 0);
+
+    // a universe that is not routed is counted, never copied
+    artnetRing ring;
+    ring.begin();
+    artnetUdp udp;
+    udp.begin(&ring);
+    udp.setDmxFilter(filter);
+    wanted = 5;
+    len = artDmx(6, 512, 1);
+    struct pbuf p = { NULL, packet, len, len };
+    udp.receive(&p, 0x0a00000a, 1000);
+    CHECK(filtered == 1);
+    CHECK(ring.accepted() == 0);
+    CHECK(ring.front() == NULL);
+
+    len = artDmx(5, 512, 2);
+    p.tot_len = p.len = len;
+    udp.receive(&p, 0x0a00000a, 1000);
+    CHECK(ring.accepted() == 1);
+    globalStruct *f = ring.front();
+    CHECK(f != NULL && f->universe == 5 && f->length == 512 && f->data[0] == 1 && f->data[511] == 0);
+    ring.pop();
+
+    // payload and even the header split over a chain
+    len = artDmx(5, 100, 3);
+    for (uint16_t split = 1; split < len; split += 7) {
+        struct pbuf second = { NULL, packet + split, (uint16_t)(len - split), (uint16_t)(len - split) };
+        struct pbuf first = { &second, packet, len, split };
+        udp.receive(&first, 0x0a00000a, 1000);
+        f = ring.front();
+        bool same = (f != NULL) && (f->length == 100);
+        for (int i = 0; same && (i < 100); i++) same = f->data[i] == i + 1;
+        CHECK(same);
+        if (f) ring.pop();
+    }
+    uint8_t out[8];
+    struct pbuf c = { NULL, packet + 4, 4, 4 };
+    struct pbuf b = { &c, packet, 8, 4 };
+    CHECK(artnetCopy(&b, 2, out, 8) == 6);
+    CHECK(memcmp(out, packet + 2, 6) == 0);
+
+    // not Art-Net at all
+    uint32_t invalid = udp.invalid();
+    struct pbuf junk = { NULL, packet + 1, 40, 40 };
+    udp.receive(&junk, 0x0a00000a, 1000);
+    CHECK(udp.invalid() == invalid + 1);
+
+    return checkDone("test_artnet_udp");
+}
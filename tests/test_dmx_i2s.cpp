@@ -0,0 +1,88 @@
+/*
+ * Host test of the DMX output over I2S, see dmx_i2s.h
+ *
+ * dmxI2sDecode(dmxI2sEncode(x)) must give x back for any length and
+ * break/MAB timing, and the words dmxI2sOutput writes to the modelled
+ * DMA ring must decode to the frame that was published.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "dmx_hw.h"
+#include "dmx_i2s.h"
+
+static uint32_t words[DMX_I2S_FRAME_WORDS];
+static uint8_t data[DMX_SLOTS];
+static uint8_t slots[DMX_SLOTS + 1];
+
+// leading low bits of an encoded frame, in microseconds
+static uint32_t breakUs(const uint32_t *w) {
+    uint32_t bit = 0;
+    while (!((w[bit >> 5] >> (31 - (bit & 31))) & 1)) bit++;
+    return bit * DMX_BIT_US;
+}
+
+int main() {
+    srand(1);
+
+    // round trip
+    static const uint16_t lengths[] = { 0, 1, 24, 100, 511, 512 };
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        for (int run = 0; run < 20; run++) {
+            uint16_t length = lengths[l];
+            for (int i = 0; i < length; i++) data[i] = rand();
+            if (run == 1) memset(data, 0x00, length);
+            if (run == 2) memset(data, 0xff, length);
+            uint16_t breakus = DMX_BREAK + rand() % 400;
+            uint16_t mabus = DMX_MAB + rand() % 100;
+            uint16_t n = dmxI2sEncode(data, length, breakus, mabus, words, DMX_I2S_FRAME_WORDS);
+            CHECK(n > 0 && n <= DMX_I2S_FRAME_WORDS);
+            CHECK(breakUs(words) >= breakus);
+            int got = dmxI2sDecode(words, n, slots, sizeof(slots));
+            CHECK(got == length + 1);
+            CHECK(slots[0] == 0);
+            CHECK(memcmp(slots + 1, data, length) == 0);
+        }
+    }
+
+    // the longest frame fits
+    uint16_t n = dmxI2sEncode(data, DMX_SLOTS, DMX_BREAK_MAX, DMX_BREAK_MAX, words, DMX_I2S_FRAME_WORDS);
+    CHECK(dmxI2sDecode(words, n, slots, sizeof(slots)) == DMX_SLOTS + 1);
+
+    // the minimum break and MAB are not cut
+    n = dmxI2sEncode(data, 10, DMX_BREAK, DMX_MAB, words, DMX_I2S_FRAME_WORDS);
+    CHECK(breakUs(words) >= 92);
+    CHECK(dmxI2sDecode(words, n, slots, sizeof(slots)) == 11);
+
+    // a frame too short in break or with a broken stop bit is refused
+    n = dmxI2sEncode(data, 10, 40, DMX_MAB, words, DMX_I2S_FRAME_WORDS);
+    CHECK(dmxI2sDecode(words, n, slots, sizeof(slots)) == -1);
+
+    // the output feeds the DMA ring with the published frame
+    dmxHostReset();
+    setBreakTiming(DMX_BREAK_DEFAULT, DMX_MAB_DEFAULT);
+    frameBuffer frames;
+    frames.begin();
+    globalStruct *b = frames.back();
+    for (int i = 0; i < DMX_SLOTS; i++) b->data[i] = (uint8_t)(255 - i);
+    b->length = 64;
+    frames.publish();
+    dmxI2sOutput dmx2;
+    dmx2.begin(2);
+    dmx2.run(&frames, 25000, DMX_SLOTS);
+    // begin() filled the ring with mark, the frame follows once there is room
+    for (int i = 0; i < 20; i++) {
+        dmxHostRun(1000);
+        dmx2.handle();
+    }
+    CHECK(dmx2.frames() == 1);
+    int first = 0;
+    while ((first < dmxHostI2sLen) && (dmxHostI2s[first] == DMX_I2S_IDLE)) first++;
+    CHECK(first < dmxHostI2sLen);
+    int got = dmxI2sDecode(dmxHostI2s + first, dmxHostI2sLen - first, slots, sizeof(slots));
+    CHECK(got == 65);
+    CHECK(memcmp(slots + 1, b->data, 64) == 0);
+
+    return checkDone("test_dmx_i2s");
+}
@@ -0,0 +1,100 @@
+/*
+ * Host test of the HTP/LTP merge, see dmx_merge.h
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "dmx_merge.h"
+#include "dmx_frames.h"
+
+static uint32_t a[FRAME_SIZE / 4], b[FRAME_SIZE / 4], out[FRAME_SIZE / 4], cur[FRAME_SIZE / 4];
+
+int main() {
+    uint8_t *pa = (uint8_t *)a, *pb = (uint8_t *)b, *po = (uint8_t *)out;
+    srand(1);
+
+    // the word kernel against a plain per channel max
+    bool same = true;
+    for (int run = 0; run < 1000; run++) {
+        for (int i = 0; i < FRAME_SIZE; i++) {
+            pa[i] = rand();
+            pb[i] = (run & 1) ? pa[i] ^ (1 << (rand() % 8)) : rand();
+        }
+        if (run == 2) { memset(pa, 0xff, FRAME_SIZE); memset(pb, 0x00, FRAME_SIZE); }
+        if (run == 3) { memset(pa, 0x80, FRAME_SIZE); memset(pb, 0x7f, FRAME_SIZE); }
+        mergeHtp(po, pa, pb, FRAME_SIZE);
+        for (int i = 0; i < FRAME_SIZE; i++) same = same && (po[i] == ((pa[i] > pb[i]) ? pa[i] : pb[i]));
+    }
+    CHECK(same);
+
+    // and the LTP kernel against a per channel select
+    same = true;
+    for (int run = 0; run < 1000; run++) {
+        for (int i = 0; i < FRAME_SIZE; i++) {
+            pa[i] = rand();
+            pb[i] = (rand() & 1) ? pa[i] : pa[i] ^ (1 << (rand() % 8));
+            ((uint8_t *)cur)[i] = rand();
+        }
+        mergeLtp(po, (uint8_t *)cur, pa, pb, FRAME_SIZE);
+        for (int i = 0; i < FRAME_SIZE; i++) same = same && (po[i] == ((pa[i] != pb[i]) ? pb[i] : ((uint8_t *)cur)[i]));
+    }
+    CHECK(same);
+
+    dmxMerge m;
+    uint16_t len;
+    memset(cur, 0, sizeof(cur));
+    for (int i = 0; i < FRAME_SIZE; i++) { pa[i] = i; pb[i] = 255 - i; }
+
+    // one source goes through unchanged
+    CHECK(m.update(1, 0, pa, 512, (uint8_t *)cur, 512, po, &len, 0) == MERGE_SINGLE);
+    CHECK(!m.merging(0));
+
+    // a second sender merges HTP
+    CHECK(m.update(2, 0, pb, 100, pa, 512, po, &len, 10) == MERGE_MERGED);
+    CHECK(m.merging(10));
+    CHECK(len == 512);
+    CHECK(po[0] == 255 && po[50] == 205 && po[200] == 200);
+
+    // a third is ignored
+    CHECK(m.update(3, 0, pb, 512, pa, 512, po, &len, 20) == MERGE_IGNORED);
+
+    // LTP takes the channels a source changed, the rest stays as it is on the output
+    m.setMode(MERGE_LTP);
+    pb[1] = 7;
+    CHECK(m.update(2, 0, pb, 100, pa, 512, po, &len, 30) == MERGE_MERGED);
+    CHECK(len == 512 && po[0] == 0 && po[1] == 7 && po[2] == 2);
+
+    // the other source times out
+    CHECK(m.update(2, 0, pb, 100, pa, 512, po, &len, 30 + MERGE_TIMEOUT + 1) == MERGE_SINGLE);
+    CHECK(!m.merging(30 + MERGE_TIMEOUT + 1));
+
+    // one console with two universes is two sources
+    dmxMerge n;
+    CHECK(n.update(1, 5, pa, 512, (uint8_t *)cur, 512, po, &len, 0) == MERGE_SINGLE);
+    CHECK(n.update(1, 6, pb, 512, pa, 512, po, &len, 10) == MERGE_MERGED);
+
+    // two sources changing different channels both get through
+    dmxMerge l;
+    l.setMode(MERGE_LTP);
+    memset(pa, 10, FRAME_SIZE);
+    memset(pb, 20, FRAME_SIZE);
+    CHECK(l.update(1, 0, pa, 512, (uint8_t *)cur, 512, po, &len, 0) == MERGE_SINGLE);
+    memcpy(cur, pa, FRAME_SIZE);
+    CHECK(l.update(2, 0, pb, 512, (uint8_t *)cur, 512, po, &len, 10) == MERGE_MERGED);
+    CHECK(po[0] == 20 && po[511] == 20);
+    memcpy(cur, po, FRAME_SIZE);
+    pa[0] = 100;
+    CHECK(l.update(1, 0, pa, 512, (uint8_t *)cur, 512, po, &len, 20) == MERGE_MERGED);
+    CHECK(po[0] == 100 && po[1] == 20 && po[5] == 20);
+    memcpy(cur, po, FRAME_SIZE);
+    pb[5] = 50;
+    CHECK(l.update(2, 0, pb, 512, (uint8_t *)cur, 512, po, &len, 30) == MERGE_MERGED);
+    CHECK(po[0] == 100 && po[5] == 50 && po[6] == 20);
+    memcpy(cur, po, FRAME_SIZE);
+    // a repeated frame changes nothing
+    CHECK(l.update(1, 0, pa, 512, (uint8_t *)cur, 512, po, &len, 40) == MERGE_MERGED);
+    CHECK(memcmp(po, cur, FRAME_SIZE) == 0);
+
+    return checkDone("test_dmx_merge");
+}
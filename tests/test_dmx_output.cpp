@@ -0,0 +1,84 @@
+/*
+ * Host test of the interrupt driven DMX output, see dmx_output.h
+ *
+ * Replays the UART1 line of the host model and checks the slot framing:
+ * start code, every channel in order, start and stop bits, and that
+ * send() does not block and refuses a second frame while one goes out.
+ */
+
+#include <string.h>
+#include "check.h"
+#include "dmx_line.h"
+#include "dmx_output.h"
+
+static uint8_t data[DMX_SLOTS];
+
+static void checkFrame(const dmxLineFrame *f, uint16_t length) {
+    CHECK(f->slots == length + 1);
+    CHECK(f->slot[0] == 0);
+    bool same = true;
+    for (int i = 0; (i < length) && (i + 1 < f->slots); i++) same = same && (f->slot[i + 1] == data[i]);
+    CHECK(same);
+}
+
+int main() {
+    for (int i = 0; i < DMX_SLOTS; i++) data[i] = (uint8_t)(i * 7 + 3);
+    data[10] = 0x00;
+    data[11] = 0xff;
+
+    dmxHostReset();
+    dmxOutput dmx(1);
+    dmx.begin();
+
+    // a full frame, send() returns at once
+    CHECK(dmx.send(data, DMX_SLOTS));
+    CHECK(dmx.busy());
+    CHECK(!dmx.send(data, DMX_SLOTS));
+    dmxHostRun(30000);
+    CHECK(!dmx.busy());
+    CHECK(dmx.state() == DMX_STATE_DONE);
+
+    dmxLineFrame f;
+    CHECK(dmxLineDecode(0, &f) != 0);
+    checkFrame(&f, DMX_SLOTS);
+    CHECK(dmxUartHost[1].count == 0);
+
+    // a short frame, longer than the FIFO is covered above
+    uint32_t after = dmxHostNow;
+    CHECK(dmx.send(data, 24));
+    dmxHostRun(5000);
+    CHECK(dmxLineDecode(after, &f) != 0);
+    checkFrame(&f, 24);
+
+    // more than 512 channels are cut
+    after = dmxHostNow;
+    static uint8_t big[600];
+    memcpy(big, data, DMX_SLOTS);
+    CHECK(dmx.send(big, 600));
+    dmxHostRun(30000);
+    CHECK(dmxLineDecode(after, &f) != 0);
+    checkFrame(&f, DMX_SLOTS);
+
+    // free running from a frame buffer, every frame carries the latest data
+    frameBuffer frames;
+    frames.begin();
+    globalStruct *b = frames.back();
+    memcpy(b->data, data, DMX_SLOTS);
+    b->length = 100;
+    frames.publish();
+    after = dmxHostNow;
+    dmx.run(&frames, 25000, DMX_SLOTS);
+    dmxHostRun(100000);
+    dmx.stop();
+    dmxHostRun(30000);
+    int count = 0;
+    uint32_t t = after;
+    while ((t = dmxLineDecode(t, &f)) != 0) {
+        checkFrame(&f, 100);
+        count++;
+    }
+    CHECK(count >= 4);
+    CHECK(dmx.stats().overruns == 0);
+
+    return checkDone("test_dmx_output");
+}
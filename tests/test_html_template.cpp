@@ -0,0 +1,67 @@
+/*
+ * Host test of the compiled HTML templates, see html_template.h
+ *
+ * Renders every page of html_pages.h with getters that write their
+ * placeholder back, the result must be the template in html/ byte for
+ * byte. Fails when html_pages.h was not regenerated after a change.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+#include "html_pages.h"
+
+static char out[16384];
+static size_t outLength;
+
+static void put(const char *text, size_t len) {
+    if (outLength + len > sizeof(out)) return;
+    memcpy(out + outLength, text, len);
+    outLength += len;
+}
+
+static void span(PGM_P text, size_t len) {
+    put(text, len);
+}
+
+#define GETTER(name) void html_##name() { put("{{" #name "}}", strlen("{{" #name "}}")); }
+GETTER(breakus)
+GETTER(channels)
+GETTER(delay)
+GETTER(fwURL)
+GETTER(holdsecs)
+GETTER(hostname)
+GETTER(mabus)
+GETTER(mergeMode)
+GETTER(monitorPort)
+GETTER(monitorPorts)
+GETTER(nav)
+GETTER(pOnShowCh1)
+GETTER(pOnShowNumCh)
+GETTER(ports)
+GETTER(refresh)
+GETTER(routes)
+GETTER(shortFrames)
+GETTER(universe)
+GETTER(universe2)
+
+static void same(const htmlTemplate *t, const char *path) {
+    static char source[16384];
+    FILE *f = fopen(path, "r");
+    CHECK(f != NULL);
+    if (f == NULL) return;
+    size_t n = fread(source, 1, sizeof(source), f);
+    fclose(f);
+    outLength = 0;
+    htmlRender(t, span);
+    CHECK(outLength == n);
+    CHECK(memcmp(out, source, n) == 0);
+}
+
+int main() {
+    same(&html_head, "../html/head.html");
+    same(&html_foot, "../html/foot.html");
+    same(&html_config, "../html/config.html");
+    same(&html_monitor, "../html/monitor.html");
+    return checkDone("test_html_template");
+}
@@ -0,0 +1,145 @@
+/*
+ * Host test of the version check request and response, see http_response.h
+ *
+ * A stand-in for the update server answers the request with
+ * esp-dmx-release.txt, honouring If-None-Match and If-Modified-Since as a
+ * web server does. Its answer reaches the parser in pieces of varying
+ * size, the way TCP hands them over.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+#include "http_response.h"
+
+#define ETAG "\"eb-5f1c2a\""
+#define MODIFIED "Tue, 06 Oct 2026 10:00:00 GMT"
+
+static char release[1024];
+static char answer[4096];
+
+// value of a request header, empty when not there
+static void requestHeader(const char *request, const char *name, char *value, size_t size) {
+    value[0] = 0;
+    const char *h = strstr(request, name);
+    if (h == NULL) return;
+    h += strlen(name);
+    size_t n = strcspn(h, "\r");
+    if (n >= size) n = size - 1;
+    memcpy(value, h, n);
+    value[n] = 0;
+}
+
+// the update server, HTTP/1.0 answers without chunking
+static int standIn(const char *request) {
+    if (strncmp(request, "GET /esp-dmx-release.txt HTTP/1.0\r\n", 35) != 0) {
+        return snprintf(answer, sizeof(answer), "HTTP/1.0 404 Not Found\r\nContent-Type: text/plain\r\n\r\nnot here\n");
+    }
+    char etag[80], since[80];
+    requestHeader(request, "\r\nIf-None-Match: ", etag, sizeof(etag));
+    requestHeader(request, "\r\nIf-Modified-Since: ", since, sizeof(since));
+    if ((strcmp(etag, ETAG) == 0) || (strcmp(since, MODIFIED) == 0)) {
+        return snprintf(answer, sizeof(answer), "HTTP/1.0 304 Not Modified\r\nETag: " ETAG "\r\n\r\n");
+    }
+    return snprintf(answer, sizeof(answer),
+                    "HTTP/1.0 200 OK\r\nServer: stand-in\r\nContent-Length: %d\r\netag:  " ETAG " \r\n"
+                    "Last-Modified: " MODIFIED "\r\nContent-Type: text/plain\r\n\r\n%s",
+                    (int)strlen(release), release);
+}
+
+// hand the answer over in pieces of 1 to step bytes
+static void receive(httpResponse *r, int length, int step) {
+    r->begin();
+    int piece = 1;
+    for (int at = 0; at < length; at += piece) {
+        piece = 1 + (at * 7) % step;
+        if (at + piece > length) piece = length - at;
+        r->feed((const uint8_t *)answer + at, piece);
+    }
+}
+
+int main() {
+    FILE *f = fopen("../esp-dmx-release.txt", "r");
+    CHECK(f != NULL);
+    if (f == NULL) return checkDone("test_http_response");
+    size_t n = fread(release, 1, sizeof(release) - 1, f);
+    release[n] = 0;
+    fclose(f);
+
+    httpResponse r;
+    char request[256];
+    char etag[HTTP_VALIDATOR_MAX] = "";
+    char modified[HTTP_VALIDATOR_MAX] = "";
+
+    // first check, unconditional
+    int length = httpRequest(request, sizeof(request), "192.168.15.14", "/esp-dmx-release.txt", etag, modified);
+    CHECK(length > 0);
+    CHECK(strstr(request, "HTTP/1.0\r\n") != NULL);
+    CHECK(strstr(request, "If-None-Match") == NULL);
+    CHECK(strcmp(request + length - 4, "\r\n\r\n") == 0);
+    for (int step = 1; step <= 300; step += 37) {
+        receive(&r, standIn(request), step);
+        CHECK(r.code() == 200);
+        CHECK(r.headDone());
+        CHECK(strcmp(r.body(), release) == 0);
+        CHECK(r.bodyLength() == strlen(release));
+        CHECK(strcmp(r.etag(), ETAG) == 0);
+        CHECK(strcmp(r.lastModified(), MODIFIED) == 0);
+        CHECK(r.complete());
+    }
+
+    // the connection ends before the body does
+    length = standIn(request);
+    receive(&r, length - 5, 64);
+    CHECK(r.code() == 200);
+    CHECK(!r.complete());
+    CHECK(strstr(r.body(), "Latest-release: 1.4\n") != NULL);
+
+    // next check with the validators, the file did not change
+    strcpy(etag, r.etag());
+    strcpy(modified, r.lastModified());
+    length = httpRequest(request, sizeof(request), "192.168.15.14", "/esp-dmx-release.txt", etag, modified);
+    CHECK(strstr(request, "\r\nIf-None-Match: " ETAG "\r\n") != NULL);
+    CHECK(strstr(request, "\r\nIf-Modified-Since: " MODIFIED "\r\n") != NULL);
+    receive(&r, standIn(request), 16);
+    CHECK(r.code() == 304);
+    CHECK(r.headDone());
+    CHECK(r.bodyLength() == 0);
+
+    // errors
+    length = httpRequest(request, sizeof(request), "192.168.15.14", "/missing.txt", "", "");
+    receive(&r, standIn(request), 5);
+    CHECK(r.code() == 404);
+    r.begin();
+    r.feed((const uint8_t *)"garbage\r\n\r\n", 11);
+    CHECK(r.code() == -1);
+    CHECK(httpRequest(request, 40, "192.168.15.14", "/esp-dmx-release.txt", etag, modified) == -1);
+
+    // long header lines and bodies are cut, not overrun
+    static char big[2048];
+    int at = sprintf(big, "HTTP/1.0 200 OK\r\nX-Long: ");
+    memset(big + at, 'x', 400);
+    at += 400;
+    at += sprintf(big + at, "\r\nETag: \"1\"\r\n\r\n");
+    memset(big + at, 'y', 1000);
+    at += 1000;
+    r.begin();
+    r.feed((const uint8_t *)big, at);
+    CHECK(r.code() == 200);
+    CHECK(strcmp(r.etag(), "\"1\"") == 0);
+    CHECK(r.bodyLength() == HTTP_BODY_MAX);
+    CHECK(strlen(r.body()) == HTTP_BODY_MAX);
+    CHECK(r.complete());
+
+    // a body longer than the buffer still counts as whole
+    at = sprintf(big, "HTTP/1.0 200 OK\r\nContent-Length: 1000\r\n\r\n");
+    memset(big + at, 'y', 1000);
+    r.begin();
+    r.feed((const uint8_t *)big, at + 999);
+    CHECK(!r.complete());
+    r.feed((const uint8_t *)big + at + 999, 1);
+    CHECK(r.complete());
+    CHECK(r.bodyLength() == HTTP_BODY_MAX);
+
+    return checkDone("test_http_response");
+}
@@ -0,0 +1,207 @@
+/*
+ * Host test of /metrics, see metrics.h
+ *
+ * The output is read back with a parser of the Prometheus text format,
+ * version 0.0.4: HELP and TYPE once per family and before its samples,
+ * metric and label names, quoted label values, numeric values, counters
+ * named _total, no series twice, every line ended by a newline.
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "check.h"
+#include "metrics.h"
+
+class textOut : public Print {
+    public:
+        char text[8192];
+        size_t length;
+
+        textOut() : length(0) {}
+        size_t write(uint8_t c) {
+            if (this->length < sizeof(this->text) - 1) this->text[this->length++] = c;
+            this->text[this->length] = 0;
+            return 1;
+        }
+};
+
+#define FAMILIES 64
+#define SERIES 128
+
+struct family {
+    char name[80];
+    char type[16];
+    bool help;
+    int samples;
+};
+
+static family families[FAMILIES];
+static int familyCount;
+static char series[SERIES][160];
+static int seriesCount;
+static char errorLine[200];
+
+static family *findFamily(const char *name, size_t len) {
+    for (int i = 0; i < familyCount; i++) {
+        if ((strlen(families[i].name) == len) && (strncmp(families[i].name, name, len) == 0)) return &families[i];
+    }
+    if (familyCount >= FAMILIES) return NULL;
+    family *f = &families[familyCount++];
+    snprintf(f->name, sizeof(f->name), "%.*s", (int)len, name);
+    f->type[0] = 0;
+    f->help = false;
+    f->samples = 0;
+    return f;
+}
+
+// [a-zA-Z_:][a-zA-Z0-9_:]*, returns the length
+static size_t metricName(const char *p) {
+    size_t n = 0;
+    if (!(isalpha((unsigned char)p[0]) || p[0] == '_' || p[0] == ':')) return 0;
+    while (isalnum((unsigned char)p[n]) || p[n] == '_' || p[n] == ':') n++;
+    return n;
+}
+
+static size_t labelName(const char *p) {
+    size_t n = 0;
+    if (!(isalpha((unsigned char)p[0]) || p[0] == '_')) return 0;
+    while (isalnum((unsigned char)p[n]) || p[n] == '_') n++;
+    return n;
+}
+
+static bool fail(const char *line, size_t len) {
+    snprintf(errorLine, sizeof(errorLine), "%.*s", (int)len, line);
+    return false;
+}
+
+static bool parseLine(const char *line, size_t len) {
+    char text[256];
+    if (len >= sizeof(text)) return fail(line, len);
+    memcpy(text, line, len);
+    text[len] = 0;
+
+    if (strncmp(text, "# HELP ", 7) == 0 || strncmp(text, "# TYPE ", 7) == 0) {
+        bool help = text[2] == 'H';
+        size_t n = metricName(text + 7);
+        if ((n == 0) || (text[7 + n] != ' ')) return fail(line, len);
+        family *f = findFamily(text + 7, n);
+        if ((f == NULL) || (f->samples > 0)) return fail(line, len);   // must come before the samples
+        const char *rest = text + 7 + n + 1;
+        if (help) {
+            if (f->help || (*rest == 0)) return fail(line, len);
+            f->help = true;
+        } else {
+            if (f->type[0]) return fail(line, len);
+            if (strcmp(rest, "counter") && strcmp(rest, "gauge") && strcmp(rest, "untyped")) return fail(line, len);
+            snprintf(f->type, sizeof(f->type), "%s", rest);
+        }
+        return true;
+    }
+    if (text[0] == '#') return true;    // comment
+
+    size_t n = metricName(text);
+    if (n == 0) return fail(line, len);
+    family *f = findFamily(text, n);
+    if ((f == NULL) || !f->type[0] || !f->help) return fail(line, len);
+    const char *p = text + n;
+    if (*p == '{') {
+        p++;
+        while (*p != '}') {
+            size_t l = labelName(p);
+            if ((l == 0) || (p[l] != '=') || (p[l + 1] != '"')) return fail(line, len);
+            p += l + 2;
+            while (*p && *p != '"') p += (*p == '\\') ? 2 : 1;
+            if (*p != '"') return fail(line, len);
+            p++;
+            if (*p == ',') p++;
+            else if (*p != '}') return fail(line, len);
+        }
+        p++;
+    }
+    size_t id = p - text;
+    if (*p++ != ' ') return fail(line, len);
+    char *end;
+    strtod(p, &end);
+    if ((end == p) || (*end != 0)) return fail(line, len);
+    for (int i = 0; i < seriesCount; i++) {
+        if ((strlen(series[i]) == id) && (strncmp(series[i], text, id) == 0)) return fail(line, len);
+    }
+    if (seriesCount < SERIES) snprintf(series[seriesCount++], sizeof(series[0]), "%.*s", (int)id, text);
+    f->samples++;
+    return true;
+}
+
+static bool parse(const char *text, size_t length) {
+    familyCount = 0;
+    seriesCount = 0;
+    errorLine[0] = 0;
+    if ((length == 0) || (text[length - 1] != '\n')) return false;
+    const char *line = text;
+    while (line < text + length) {
+        const char *nl = (const char *)memchr(line, '\n', text + length - line);
+        if (!parseLine(line, nl - line)) return false;
+        line = nl + 1;
+    }
+    for (int i = 0; i < familyCount; i++) {
+        if (families[i].samples == 0) return false;
+        size_t n = strlen(families[i].name);
+        bool total = (n > 6) && (strcmp(families[i].name + n - 6, "_total") == 0);
+        if ((strcmp(families[i].type, "counter") == 0) != total) {
+            snprintf(errorLine, sizeof(errorLine), "%.80s is a %.16s", families[i].name, families[i].type);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool has(const char *text, const char *line) {
+    return strstr(text, line) != NULL;
+}
+
+int main() {
+    metricsValues v;
+    memset(&v, 0, sizeof(v));
+    v.artnetPackets = 4294967295UL;
+    v.ports = 2;
+    v.frames[0] = 1200;
+    v.frames[1] = 1199;
+    v.jitterMax = -12;
+    v.temperature = -5;
+    v.rssi = -67;
+    v.freeHeap = 21000;
+    v.uptime = 3600;
+
+    textOut out;
+    metricsWrite(&v, out);
+    bool ok = parse(out.text, out.length);
+    if (!ok) printf("test_metrics: %s\n", errorLine);
+    CHECK(ok);
+    CHECK(has(out.text, "\nesp_dmx_artnet_packets_total 4294967295\n"));
+    CHECK(has(out.text, "\nesp_dmx_frames_total{port=\"2\"} 1199\n"));
+    CHECK(has(out.text, "\nesp_dmx_temperature_celsius -5\n"));
+    CHECK(has(out.text, "\nesp_dmx_frame_jitter_max_microseconds -12\n"));
+    CHECK(has(out.text, "\n# TYPE esp_dmx_uptime_seconds gauge\nesp_dmx_uptime_seconds 3600\n"));
+    CHECK(!has(out.text, "send_microseconds"));
+
+    // one port, no second series
+    v.ports = 1;
+    textOut one;
+    metricsWrite(&v, one);
+    CHECK(parse(one.text, one.length));
+    CHECK(!has(one.text, "port=\"2\""));
+
+    // the parser finds what it should
+    const char *bad[] = {
+        "# HELP x_total a\n# TYPE x_total counter\nx_total 1\nx_total 2\n",      // series twice
+        "# HELP x a\n# TYPE x counter\nx 1\n",                                   // counter without _total
+        "# HELP x a\n# TYPE x gauge\nx{a=b} 1\n",                                // label not quoted
+        "# HELP x a\n# TYPE x gauge\nx 1",                                       // no newline at the end
+        "x 1\n",                                                                 // no TYPE
+        "# HELP x a\n# TYPE x gauge\nx one\n",                                   // not a number
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) CHECK(!parse(bad[i], strlen(bad[i])));
+
+    return checkDone("test_metrics");
+}
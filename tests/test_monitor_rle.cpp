@@ -0,0 +1,141 @@
+/*
+ * Host test of the monitor delta encoding, see monitor_rle.h
+ *
+ * Round trips of random and patterned universes through rleEncode() and
+ * rleDecode(): the decoded channels must equal the frame, and no frame
+ * may need more than MONITOR_FRAME_MAX bytes, the buffer of the monitor.
+ * Broken frames must be refused, not written past the channels.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "check.h"
+#include "monitor_rle.h"
+
+#define ROUNDS 20000
+
+static uint8_t prev[512], cur[512], mirror[512 + 16];
+static uint8_t frame[MONITOR_FRAME_MAX];
+static int worst;
+static int failures;
+
+static uint32_t state = 1;
+static uint32_t rnd() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// changes to cur against prev, in the shape of pattern
+static void change(int pattern, uint16_t channels) {
+    memcpy(cur, prev, sizeof(cur));
+    switch (pattern) {
+        case 0:     // a few channels
+            for (int k = rnd() % 20; k > 0; k--) cur[rnd() % channels]++;
+            break;
+        case 1:     // everything new
+            for (int i = 0; i < channels; i++) cur[i] = rnd();
+            break;
+        case 2: {   // changed channels every gap, gaps around RLE_GAP
+            int gap = 1 + rnd() % 8;
+            for (int i = rnd() % gap; i < channels; i += gap) cur[i] = prev[i] + 1 + rnd() % 255;
+            break;
+        }
+        case 3: {   // runs of lengths around RLE_MIN_RUN and RLE_BREAK_RUN
+            int i = 0;
+            while (i < channels) {
+                int run = 1 + rnd() % 10;
+                uint8_t v = rnd();
+                for (int k = 0; (k < run) && (i < channels); k++, i++) cur[i] = v;
+            }
+            break;
+        }
+        case 4: {   // literals broken up by short unchanged stretches
+            for (int i = 0; i < channels; i++) {
+                if ((i % (4 + rnd() % 3)) != 0) cur[i] = prev[i] ^ (1 + rnd() % 255);
+            }
+            break;
+        }
+        default:    // fades, neighbours differ by one
+            for (int i = 0; i < channels; i++) cur[i] = prev[i] + 1 + (i & 1);
+            break;
+    }
+}
+
+static void roundTrip(uint8_t type, uint16_t channels) {
+    const uint8_t *base = (type == MONITOR_FULL) ? NULL : prev;
+    int len = rleEncode(type, 1, base, cur, channels, frame, sizeof(frame));
+    if (len < 0) {
+        failures++;
+        return;
+    }
+    if (len > worst) worst = len;
+    if (type == MONITOR_FULL) {
+        memset(mirror, 0x55, sizeof(mirror));
+    } else {
+        memcpy(mirror, prev, sizeof(prev));
+        memset(mirror + 512, 0x55, sizeof(mirror) - 512);
+    }
+    if (rleDecode(frame, len, mirror, 512) != channels) failures++;
+    else if (memcmp(mirror, cur, channels) != 0) failures++;
+    else if ((type == MONITOR_FULL) && (channels < 512) && (mirror[channels] != 0)) failures++;
+    else if (mirror[512] != 0x55) failures++;
+}
+
+int main() {
+    for (int r = 0; r < ROUNDS; r++) {
+        uint16_t channels = (r % 4 == 0) ? 512 : 1 + rnd() % 512;
+        change(r % 6, channels);
+        roundTrip(MONITOR_DELTA, channels);
+        roundTrip(MONITOR_FULL, channels);
+        memcpy(prev, cur, sizeof(prev));
+    }
+    CHECK(failures == 0);
+
+    // every channel a new value that differs from its neighbours, all literals
+    for (int i = 0; i < 512; i++) {
+        prev[i] = 0;
+        cur[i] = 1 + (i % 2) + 2 * (i % 3);
+    }
+    roundTrip(MONITOR_FULL, 512);
+    CHECK(failures == 0);
+    printf("test_monitor_rle: worst frame %d of %d bytes\n", worst, MONITOR_FRAME_MAX);
+    CHECK(worst <= MONITOR_FRAME_MAX);
+
+    // nothing changed, only the header
+    memcpy(cur, prev, sizeof(cur));
+    CHECK(rleEncode(MONITOR_DELTA, 1, prev, cur, 512, frame, sizeof(frame)) == MONITOR_HEADER);
+
+    // too small a buffer is refused
+    for (int i = 0; i < 512; i++) cur[i] = rnd();
+    CHECK(rleEncode(MONITOR_FULL, 1, NULL, cur, 512, frame, 100) == -1);
+
+    // broken frames: cut short, or claiming more channels than there are
+    int len = rleEncode(MONITOR_FULL, 1, NULL, cur, 512, frame, sizeof(frame));
+    bool refused = true;
+    for (int cut = MONITOR_HEADER + 1; cut < len; cut++) {
+        memset(mirror, 0x55, sizeof(mirror));
+        int n = rleDecode(frame, cut, mirror, 512);
+        if (mirror[512] != 0x55) refused = false;
+        if ((n != -1) && (n != 512)) refused = false;
+    }
+    CHECK(refused);
+    CHECK(rleDecode(frame, len, mirror, 100) == -1);
+    CHECK(rleDecode(frame, 3, mirror, 512) == -1);
+
+    // random bytes never write past the channels
+    bool inside = true;
+    for (int r = 0; r < ROUNDS; r++) {
+        int n = MONITOR_HEADER + rnd() % 64;
+        for (int i = 0; i < n; i++) frame[i] = rnd();
+        frame[2] = (rnd() % 3) >> 1;
+        memset(mirror, 0x55, sizeof(mirror));
+        rleDecode(frame, n, mirror, 512);
+        if (mirror[512] != 0x55) inside = false;
+    }
+    CHECK(inside);
+
+    return checkDone("test_monitor_rle");
+}
@@ -0,0 +1,58 @@
+/*
+ * Host test of the Port-Address routing, see route_table.h
+ */
+
+#include <string.h>
+#include "check.h"
+#include "route_table.h"
+
+int main() {
+    routeTable t;
+
+    CHECK(t.parse("0.0.5=1, 0.1.0=2", 2) == 2);
+    CHECK(t.targets(5) == ROUTE_PORT(0));
+    CHECK(t.targets(16) == ROUTE_PORT(1));
+    CHECK(t.routed(5) && !t.routed(6));
+
+    // one address per port, one address may feed both
+    t.clear();
+    CHECK(t.add(0, ROUTE_PORT(0)));
+    CHECK(!t.add(5, ROUTE_PORT(0)));
+    CHECK(t.add(0, ROUTE_PORT(1)));
+    CHECK(t.targets(0) == (ROUTE_PORT(0) | ROUTE_PORT(1)));
+    CHECK(!t.routed(5));
+    t.clear();
+    CHECK(t.parse("0.0.5=1, 0.0.6=1", 2) == -1);
+    t.clear();
+    CHECK(t.parse("0.0.5=1, 0.0.5=2", 2) == 2);
+
+    // out of range
+    t.clear();
+    CHECK(t.parse("70000=1", 2) == -1);
+    CHECK(!t.routed(70000 & 0xffff));
+    CHECK(t.parse("32768=1", 2) == -1);
+    CHECK(t.parse("-1=1", 2) == -1);
+    CHECK(t.parse("128.0.0=1", 2) == -1);
+    CHECK(t.parse("0.0.1=3", 2) == -1);
+    t.clear();
+    CHECK(t.parse("32767=1", 2) == 1);
+    CHECK(t.targets(32767) == ROUTE_PORT(0));
+
+    // the Port-Address of a port is its route
+    t.clear();
+    t.parse("0.1.0=2", 2);
+    CHECK(t.portAddress(0) == -1);
+    CHECK(t.portAddress(1) == 16);
+    t.add(3, ROUTE_PORT(0));
+    t.add(16, ROUTE_PORT(1));
+    CHECK(t.portAddress(0) == 3);
+    CHECK(t.portAddress(1) == 16);
+
+    char text[64];
+    t.clear();
+    t.parse("1.2.3=2", 2);
+    t.print(text, sizeof(text));
+    CHECK(strcmp(text, "1.2.3=2") == 0);
+
+    return checkDone("test_route_table");
+}
@@ -0,0 +1,177 @@
+/*
+ * Host test of the sACN receiver, see sacn.h
+ *
+ * Packets go through receive() with the pbuf stand-in of artnet_udp.h.
+ * Only the source owning a universe may reach the filter, so a lower
+ * priority source neither advances the sequence tracking nor wakes the
+ * loop, and the tracking follows the CID, not the IP address. A universe
+ * that is not routed never takes a priority slot.
+ */
+
+#include <string.h>
+#include "check.h"
+#include "sacn.h"
+#include "artnet_seq.h"
+#include "sacn_packets.h"
+
+static uint8_t packet[SACN_HEADER + 512];
+static seqTracker sequence;
+static sourceStats senders;
+static int filtered;
+static int accepted;
+
+static bool filter(uint16_t address, uint32_t source, const uint8_t *cid, uint8_t seq) {
+    filtered++;
+    if (sequence.check(address, sacnCidKey(cid), source, seq, false) != SEQ_NEW) return false;
+    if (sequence.gap()) senders.lost(source, address, true, sequence.gap());
+    accepted++;
+    return true;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xff;
+}
+
+// E1.31 data packet of universe with slots channels, returns its length
+static uint16_t build(uint8_t cidByte, uint16_t universe, uint8_t priority, uint8_t seq, uint16_t slots) {
+    uint16_t len = SACN_HEADER + slots;
+    memset(packet, 0, sizeof(packet));
+    put16(&packet[0], 0x0010);
+    memcpy(&packet[4], "ASC-E1.17", 9);
+    put16(&packet[16], 0x7000 | (len - 16));
+    packet[21] = 0x04;
+    memset(&packet[22], cidByte, 16);
+    put16(&packet[38], 0x7000 | (len - 38));
+    packet[43] = 0x02;
+    packet[108] = priority;
+    packet[111] = seq;
+    put16(&packet[113], universe);
+    put16(&packet[115], 0x7000 | (len - 115));
+    packet[117] = 0x02;
+    packet[118] = 0xa1;
+    put16(&packet[121], 0x0001);
+    put16(&packet[123], slots + 1);
+    for (int i = 0; i < slots; i++) packet[SACN_HEADER + i] = (uint8_t)i;
+    return len;
+}
+
+static void send(sacnReceiver *r, uint8_t cidByte, uint32_t ip, uint8_t priority, uint8_t seq, uint32_t now) {
+    struct pbuf p;
+    p.next = NULL;
+    p.payload = packet;
+    p.len = p.tot_len = build(cidByte, 1, priority, seq, 16);
+    r->receive(&p, ip, now);
+}
+
+int main() {
+    artnetRing ring;
+    ring.begin();
+    sacnReceiver r;
+    r.setDmxFilter(filter);
+    r.setStats(&senders);
+    r.begin(&ring);
+    CHECK(r.addUniverse(1));
+
+    sacnDmx dmx;
+    CHECK(sacnParse(packet, build(1, 1, 100, 0, 512), &dmx));
+    CHECK(dmx.length == 512);
+    CHECK(!sacnParse(packet, build(1, 0, 100, 0, 16), &dmx));
+    CHECK(!sacnParse(packet, build(1, 1, 201, 0, 16), &dmx));
+
+    // source A at priority 100 owns the universe
+    send(&r, 0xaa, 0x0100000a, 100, 1, 0);
+    send(&r, 0xaa, 0x0100000a, 100, 2, 10);
+    CHECK(accepted == 2);
+
+    // a lower priority source B is not even looked at by the filter
+    filtered = 0;
+    send(&r, 0xbb, 0x0200000a, 50, 200, 20);
+    send(&r, 0xbb, 0x0200000a, 50, 201, 30);
+    CHECK(filtered == 0);
+    CHECK(r.ignored() == 2);
+    send(&r, 0xaa, 0x0100000a, 100, 3, 40);
+    CHECK(accepted == 3);
+    CHECK(sequence.lost() == 0);
+
+    // A moves to another IP, its sequence carries on and a repeat is a duplicate
+    send(&r, 0xaa, 0x0300000a, 100, 3, 50);
+    CHECK(accepted == 3);
+    CHECK(sequence.duplicates() == 1);
+    send(&r, 0xaa, 0x0300000a, 100, 4, 60);
+    CHECK(accepted == 4);
+
+    // two sources behind one IP are tracked apart
+    send(&r, 0xcc, 0x0300000a, 100, 90, 70);
+    CHECK(accepted == 5);
+    CHECK(sequence.lost() == 0);
+
+    // a higher priority takes over, A times out behind it
+    send(&r, 0xdd, 0x0400000a, 150, 7, 80);
+    CHECK(accepted == 6);
+    filtered = 0;
+    send(&r, 0xaa, 0x0300000a, 100, 5, 90);
+    CHECK(filtered == 0);
+
+    // universes are added again after a rebuild of the routes
+    r.clearUniverses();
+    CHECK(r.addUniverse(1));
+    CHECK(r.addUniverse(2));
+    CHECK(!r.addUniverse(0));
+
+    // the sender statistics take the loss from the sequence check, sACN
+    // sequence 0 is a frame like any other
+    sacnReceiver s;
+    s.setDmxFilter(filter);
+    s.setStats(&senders);
+    s.begin(&ring);
+    CHECK(s.addUniverse(1));
+    uint32_t lost = sequence.lost();
+    send(&s, 0x77, 0x0800000a, 100, 254, 200);
+    send(&s, 0x77, 0x0800000a, 100, 0, 210);      // 255 is lost
+    send(&s, 0x77, 0x0800000a, 100, 2, 220);      // 1 is lost
+    send(&s, 0x77, 0x0800000a, 100, 1, 230);      // late, not a gap
+    CHECK(sequence.lost() == lost + 2);
+    const sourceEntry *e = NULL;
+    for (int i = 0; i < senders.count(); i++) {
+        const sourceEntry *t = senders.entry(i, 230);
+        if (t && (t->ip == 0x0800000a)) e = t;
+    }
+    CHECK(e != NULL && e->lost == 2 && e->packets == 4);
+
+    CHECK(sacnCidKey(packet + 22) != 0);
+
+    // packets as sent on the wire
+    CHECK(sacnParse(sacnFull, sizeof(sacnFull), &dmx));
+    CHECK(dmx.universe == 1 && dmx.length == 512 && dmx.sequence == 0x42 && dmx.priority == 100 && dmx.options == 0);
+    CHECK(dmx.cid == sacnFull + 22);
+    CHECK(!sacnParse(sacnFull, sizeof(sacnFull) - 1, &dmx));
+    CHECK(sacnParse(sacnShort, sizeof(sacnShort), &dmx));
+    CHECK(dmx.universe == 2 && dmx.length == 24 && dmx.sequence == 0 && dmx.priority == 120);
+    CHECK(sacnParse(sacnPreview, sizeof(sacnPreview), &dmx) && (dmx.options & SACN_OPT_PREVIEW));
+    CHECK(sacnParse(sacnTerminated, sizeof(sacnTerminated), &dmx) && (dmx.options & SACN_OPT_TERMINATED));
+    CHECK(!sacnParse(sacnSync, sizeof(sacnSync), &dmx));
+    CHECK(!sacnParse(sacnPriority, sizeof(sacnPriority), &dmx));
+
+    // sources of universes that are not routed leave the slots free
+    sacnReceiver r2;
+    r2.setDmxFilter(filter);
+    r2.begin(&ring);
+    CHECK(r2.addUniverse(1));
+    filtered = 0;
+    struct pbuf p;
+    p.next = NULL;
+    p.payload = packet;
+    for (int i = 0; i < SACN_SOURCES; i++) {
+        p.len = p.tot_len = build(0x10 + i, 100 + i, 200, 1, 16);
+        r2.receive(&p, 0x0500000a, 100);
+    }
+    CHECK(filtered == 0);
+    CHECK(r2.ignored() == SACN_SOURCES);
+    send(&r2, 0xee, 0x0600000a, 150, 1, 110);
+    CHECK(filtered == 1);
+    filtered = 0;
+    send(&r2, 0xff, 0x0700000a, 50, 1, 120);
+    CHECK(filtered == 0);
+    return checkDone("test_sacn");
+}
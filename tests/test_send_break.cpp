@@ -0,0 +1,84 @@
+/*
+ * Host test of the break and MAB timing, see send_break.h
+ *
+ * Replays the UART1 line of the host model and checks that break and
+ * MAB are never shorter than E1.11 asks for, with the defaults, with the
+ * minimum values, and after out of range values were clamped.
+ */
+
+#include "check.h"
+#include "dmx_line.h"
+#include "dmx_output.h"
+#include "send_break.h"
+
+static uint8_t data[DMX_SLOTS];
+
+// send one frame and measure break and MAB on the line
+static void measure(dmxOutput *dmx, dmxLineFrame *f) {
+    uint32_t after = dmxHostNow;
+    CHECK(dmx->send(data, 32));
+    dmxHostRun(10000 + 2 * DMX_BREAK_MAX);
+    CHECK(dmxLineDecode(after, f) != 0);
+    CHECK(f->slots == 33);
+}
+
+int main() {
+    for (int i = 0; i < DMX_SLOTS; i++) data[i] = (uint8_t)i;
+    dmxHostReset();
+    dmxOutput dmx(1);
+    dmx.begin();
+    dmxLineFrame f;
+
+    CHECK(setBreakTiming(DMX_BREAK_DEFAULT, DMX_MAB_DEFAULT));
+    measure(&dmx, &f);
+    CHECK(f.breakUs >= DMX_BREAK_DEFAULT);
+    CHECK(f.mabUs >= DMX_MAB_DEFAULT);
+
+    CHECK(setBreakTiming(DMX_BREAK, DMX_MAB));
+    measure(&dmx, &f);
+    CHECK(f.breakUs >= 92);
+    CHECK(f.mabUs >= 12);
+    // the MAB ends with the start bit, which only comes on a bit boundary
+    CHECK(f.breakUs < DMX_BREAK + DMX_SLOT_US);
+    CHECK(f.mabUs < DMX_MAB + DMX_SLOT_US);
+
+    // too short is clamped to the minimum, too long to the maximum
+    CHECK(!setBreakTiming(40, 4));
+    CHECK(breakTime() == DMX_BREAK);
+    CHECK(mabTime() == DMX_MAB);
+    measure(&dmx, &f);
+    CHECK(f.breakUs >= 92);
+    CHECK(f.mabUs >= 12);
+
+    CHECK(!setBreakTiming(20000, 20000));
+    CHECK(breakTime() == DMX_BREAK_MAX);
+    CHECK(mabTime() == DMX_BREAK_MAX);
+
+    // a long break and MAB
+    CHECK(setBreakTiming(500, 100));
+    measure(&dmx, &f);
+    CHECK(f.breakUs >= 500);
+    CHECK(f.mabUs >= 100);
+
+    // every frame of the free running output
+    CHECK(setBreakTiming(DMX_BREAK, DMX_MAB));
+    frameBuffer frames;
+    frames.begin();
+    frames.back()->length = DMX_SLOTS;
+    frames.publish();
+    uint32_t t = dmxHostNow;
+    dmx.run(&frames, 23000, DMX_SLOTS);
+    dmxHostRun(200000);
+    dmx.stop();
+    dmxHostRun(30000);
+    int count = 0;
+    bool ok = true;
+    while ((t = dmxLineDecode(t, &f)) != 0) {
+        ok = ok && (f.breakUs >= 92) && (f.mabUs >= 12) && (f.slots == DMX_SLOTS + 1);
+        count++;
+    }
+    CHECK(ok);
+    CHECK(count >= 8);
+
+    return checkDone("test_send_break");
+}
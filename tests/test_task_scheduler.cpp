@@ -0,0 +1,117 @@
+/*
+ * Host test of the scheduler with a simulated clock, see task_scheduler.h
+ */
+
+#include "check.h"
+#include "task_scheduler.h"
+
+static uint32_t now;
+static uint32_t clock() { return now; }
+
+static int taskRuns, jobARuns, jobBRuns, slowRuns;
+static uint32_t jobCost;      // ms a job takes
+static taskScheduler *sched;
+
+static void task() { taskRuns++; }
+static void jobA() { jobARuns++; now += jobCost; }
+static void jobB() { jobBRuns++; now += jobCost; }
+static void slow() {
+    // a long job hands the due tasks their turn between its parts
+    for (int i = 0; i < 4; i++) {
+        now += 5;
+        sched->runTasks();
+    }
+    slowRuns++;
+}
+
+static void reset(uint32_t start) {
+    now = start;
+    taskRuns = jobARuns = jobBRuns = slowRuns = 0;
+    jobCost = 0;
+}
+
+// run passes until the clock reaches end, sleeping as loop() does
+static void runUntil(taskScheduler &s, uint32_t end) {
+    while ((int32_t)(now - end) < 0) {
+        uint32_t idle = s.runOnce();
+        CHECK(idle <= SCHED_SLEEP_MAX);
+        now += idle ? idle : 1;
+    }
+}
+
+static void periods(uint32_t start) {
+    reset(start);
+    taskScheduler s(clock);
+    CHECK(s.addTask(task, 10));
+    CHECK(s.addJob(jobA, 20));
+    CHECK(s.addJob(jobB, 100));
+    runUntil(s, start + 1000);
+    CHECK(taskRuns == 100);
+    CHECK(jobARuns == 49 || jobARuns == 50);
+    CHECK(jobBRuns == 9 || jobBRuns == 10);
+    CHECK(s.jobsDeferred() == 0);
+}
+
+int main() {
+    // tasks and jobs keep their periods, also when the clock wraps
+    periods(0);
+    periods(0xffffffff - 500);
+
+    // the sleep ends at the next task deadline
+    reset(0);
+    {
+        taskScheduler s(clock);
+        s.addTask(task, 10);
+        s.addJob(jobA, 1000);
+        CHECK(s.runOnce() == 10);
+        CHECK(taskRuns == 1);
+        now += 4;
+        CHECK(s.runOnce() == 6);
+        CHECK(taskRuns == 1);
+    }
+
+    // wake() runs the tasks before their deadline
+    reset(0);
+    {
+        taskScheduler s(clock);
+        s.addTask(task, 10);
+        s.runOnce();
+        now += 2;
+        s.wake();
+        CHECK(s.woken());
+        s.runOnce();
+        CHECK(taskRuns == 2);
+        CHECK(!s.woken());
+    }
+
+    // jobs that run into a task deadline are left for the next pass
+    reset(0);
+    {
+        taskScheduler s(clock);
+        s.addTask(task, 5);
+        s.addJob(jobA, 8);
+        s.addJob(jobB, 8);
+        jobCost = 6;
+        now = 8;
+        s.runOnce();
+        CHECK(jobARuns + jobBRuns == 1);
+        CHECK(s.jobsDeferred() == 1);
+        s.runOnce();
+        CHECK(jobARuns == 1 && jobBRuns == 1);
+        CHECK(taskRuns == 2);
+    }
+
+    // a long job runs the tasks from within, they do not run twice
+    reset(0);
+    {
+        taskScheduler s(clock);
+        sched = &s;
+        s.addTask(task, 5);
+        s.addJob(slow, 100);
+        runUntil(s, 1000);
+        CHECK(slowRuns == 9 || slowRuns == 10);
+        CHECK(taskRuns >= 195 && taskRuns <= 200);
+    }
+
+    return checkDone("test_task_scheduler");
+}
@@ -0,0 +1,100 @@
+/*
+ * Host test of the per host cache of the TLS client, see tls_client.h
+ *
+ * The BearSSL stand-in (tests/host/WiFiClientSecureBearSSL.h) answers
+ * fragment length probes and counts resumed sessions. Checked: the probe
+ * steps up to the size the server takes, a server without MFLN, a probe
+ * that cannot reach the host caches nothing, sessions are resumed per
+ * host, the oldest host makes room for a new one, and the client is held
+ * until release().
+ */
+
+#include <string.h>
+#include "check.h"
+#include "tls_client.h"
+
+// probe until it is over, returns the last result and the passes it took
+static int probeAll(tlsClient *tls, const char *host, int *passes) {
+    int result = TLS_PROBE_MORE;
+    for (*passes = 0; (result == TLS_PROBE_MORE) && (*passes < 10); (*passes)++) result = tls->probe(host, 443);
+    return result;
+}
+
+int main() {
+    memset(&hostNet, 0, sizeof(hostNet));
+    hostNet.reachable = true;
+    tlsClient tls;
+    int passes;
+
+    // the server takes 2048, one size per call from the smallest
+    hostNet.mfln = 2048;
+    CHECK(probeAll(&tls, "a.example", &passes) == TLS_PROBE_DONE);
+    CHECK(passes == 3);
+    CHECK(tls.mfln("a.example", 443) == 2048);
+    CHECK(tls.mfln("a.example", 8443) == 0);
+    uint32_t probes = hostNet.probes;
+    CHECK(tls.probe("a.example", 443) == TLS_PROBE_DONE);
+    CHECK(hostNet.probes == probes);
+
+    // the buffers follow the fragment length, the session is resumed
+    BearSSL::WiFiClientSecure *c = tls.connect("a.example", 443, 2000);
+    CHECK(c != NULL);
+    CHECK(hostNet.rxBuffer == 2048);
+    CHECK(hostNet.resumed == 0);
+    CHECK(tls.busy());
+    CHECK(tls.client("a.example", 443) == NULL);
+    CHECK(tls.connect("a.example", 443, 2000) == NULL);
+    tls.release();
+    CHECK(!tls.busy());
+    CHECK(tls.connect("a.example", 443, 2000) != NULL);
+    CHECK(hostNet.resumed == 1);
+    tls.release();
+    CHECK(tls.handshakes() == 2);
+
+    // a server without MFLN is probed up to the largest size, once
+    hostNet.mfln = 0;
+    CHECK(probeAll(&tls, "b.example", &passes) == TLS_PROBE_DONE);
+    CHECK(passes == 4);
+    CHECK(tls.mfln("b.example", 443) == -1);
+    CHECK(tls.connect("b.example", 443, 2000) != NULL);
+    CHECK(hostNet.rxBuffer == TLS_BUFFER_DEFAULT);
+    CHECK(hostNet.resumed == 1);        // a session of its own, not the one of a.example
+    tls.release();
+
+    // a host that cannot be reached: the probe fails and caches nothing,
+    // not even a "no MFLN"
+    hostNet.mfln = 1024;
+    hostNet.down = "c.example";
+    CHECK(tls.probe("c.example", 443) == TLS_PROBE_FAILED);
+    CHECK(tls.mfln("c.example", 443) == 0);
+    CHECK(tls.probe("c.example", 443) == TLS_PROBE_FAILED);
+    CHECK(tls.connect("c.example", 443, 2000) == NULL);
+    CHECK(!tls.busy());
+    // reachable again, probed from the smallest size
+    hostNet.down = NULL;
+    probes = hostNet.probes;
+    CHECK(probeAll(&tls, "c.example", &passes) == TLS_PROBE_DONE);
+    CHECK(hostNet.probes - probes == 2);
+    CHECK(tls.mfln("c.example", 443) == 1024);
+
+    // c.example took the place of the oldest host, a.example starts over
+    CHECK(tls.mfln("a.example", 443) == 0);
+    CHECK(tls.mfln("b.example", 443) == -1);
+    uint32_t resumed = hostNet.resumed;
+    CHECK(tls.connect("a.example", 443, 2000) != NULL);
+    CHECK(hostNet.resumed == resumed);
+    tls.release();
+
+    // split URLs
+    bool https;
+    String host, path;
+    uint16_t port;
+    CHECK(parseUrl("https://a.example:8443/fw/esp-dmx.bin", &https, &host, &port, &path));
+    CHECK(https && (host == "a.example") && (port == 8443) && (path == "/fw/esp-dmx.bin"));
+    CHECK(parseUrl("http://192.168.15.14/esp-dmx-release.txt", &https, &host, &port, &path));
+    CHECK(!https && (host == "192.168.15.14") && (port == 80));
+    CHECK(!parseUrl("ftp://a.example/x", &https, &host, &port, &path));
+    CHECK(!parseUrl("http://a.example", &https, &host, &port, &path));
+
+    return checkDone("test_tls_client");
+}
@@ -0,0 +1,133 @@
+/*
+ * Host test of the version check state machine, see version_check.h
+ *
+ * A stand-in for the update server (tests/host/WiFiClient.h) serves
+ * esp-dmx-release.txt with ETag and Content-Length and answers the
+ * conditional request with 304. The clock is simulated, every poll() is
+ * 10 ms later. Checked: new file and 304, a 200 cut off before the end of
+ * its body, the back-off while the server is down, a server that never
+ * answers, and the HTTPS path with its fragment length probe.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "check.h"
+#include "version_check.h"
+
+#define WEEK (3600UL * 24 * 7 * 1000)
+
+static char release[1024];
+static char etag[32] = "\"eb-1\"";
+static char lastRequest[512];
+
+static int standIn(const char *request, char *answer, size_t size) {
+    snprintf(lastRequest, sizeof(lastRequest), "%s", request);
+    if (strncmp(request, "GET /esp-dmx-release.txt HTTP/1.0\r\n", 35) != 0) {
+        return snprintf(answer, size, "HTTP/1.0 404 Not Found\r\n\r\n");
+    }
+    char match[64];
+    snprintf(match, sizeof(match), "\r\nIf-None-Match: %s\r\n", etag);
+    if (strstr(request, match)) return snprintf(answer, size, "HTTP/1.0 304 Not Modified\r\nETag: %s\r\n\r\n", etag);
+    return snprintf(answer, size, "HTTP/1.0 200 OK\r\nContent-Length: %d\r\nETag: %s\r\n\r\n%s", (int)strlen(release), etag, release);
+}
+
+// poll until the check is over, at most passes times
+static int run(versionCheck *v, int passes) {
+    for (int i = 0; i < passes; i++) {
+        hostMillis += 10;
+        int result = v->poll(hostMillis);
+        if (result != VERSION_NONE) return result;
+    }
+    return VERSION_NONE;
+}
+
+int main() {
+    FILE *f = fopen("../esp-dmx-release.txt", "r");
+    CHECK(f != NULL);
+    if (f == NULL) return checkDone("test_version_check");
+    size_t n = fread(release, 1, sizeof(release) - 1, f);
+    release[n] = 0;
+    fclose(f);
+
+    memset(&hostNet, 0, sizeof(hostNet));
+    hostNet.reachable = true;
+    hostNet.piece = 100;
+    hostNet.serve = standIn;
+    hostMillis = 1000;
+
+    tlsClient tls;
+    versionCheck v;
+    CHECK(v.begin("http://192.168.15.14/esp-dmx-release.txt", WEEK, &tls));
+
+    // the first check gets the file
+    CHECK(run(&v, 100) == VERSION_CHANGED);
+    CHECK(v.httpCode() == 200);
+    CHECK(strcmp(v.body(), release) == 0);
+    CHECK(v.nextCheck() == hostMillis + WEEK);
+    CHECK(v.state() == VERSION_IDLE);
+
+    // nothing before it is due, then a 304 with the validators
+    CHECK(run(&v, 100) == VERSION_NONE);
+    v.start(hostMillis);
+    CHECK(run(&v, 100) == VERSION_UNCHANGED);
+    CHECK(strstr(lastRequest, "If-None-Match: \"eb-1\"") != NULL);
+    CHECK(v.httpCode() == 304);
+
+    // a new file cut off on the way is no new release
+    strcpy(etag, "\"eb-2\"");
+    hostNet.cut = 10;
+    v.start(hostMillis);
+    CHECK(run(&v, 100) == VERSION_FAILED);
+    CHECK(v.httpCode() == -1);
+    CHECK(v.failures() == 1);
+    CHECK(v.nextCheck() == hostMillis + VERSION_RETRY);
+    hostNet.cut = 0;
+    hostMillis = v.nextCheck();
+    CHECK(run(&v, 100) == VERSION_CHANGED);
+    CHECK(v.failures() == 0);
+
+    // server down: the wait doubles up to the cap, the first success resets it
+    hostNet.reachable = false;
+    uint32_t wait = VERSION_RETRY;
+    bool doubling = true;
+    for (int i = 0; i < 10; i++) {
+        v.start(hostMillis);
+        doubling = doubling && (run(&v, 100) == VERSION_FAILED) && (v.nextCheck() - hostMillis == wait);
+        hostMillis = v.nextCheck() - 10;
+        wait = (wait * 2 > VERSION_BACKOFF_MAX) ? VERSION_BACKOFF_MAX : wait * 2;
+    }
+    CHECK(doubling);
+    CHECK(v.failures() == 10);
+    CHECK(wait == VERSION_BACKOFF_MAX);     // the last waits were at the cap
+    hostNet.reachable = true;
+    CHECK(run(&v, 100) == VERSION_UNCHANGED);
+    CHECK(v.failures() == 0);
+    CHECK(v.nextCheck() == hostMillis + WEEK);
+
+    // a server that takes the connection and never answers
+    hostNet.hold = true;
+    hostNet.serve = NULL;
+    v.start(hostMillis);
+    uint32_t started = hostMillis;
+    CHECK(run(&v, VERSION_TIMEOUT / 10 + 10) == VERSION_FAILED);
+    CHECK(v.httpCode() == -1);
+    CHECK(hostMillis - started > VERSION_TIMEOUT);
+    hostNet.hold = false;
+    hostNet.serve = standIn;
+
+    // HTTPS: the fragment length is probed once, then the client is released
+    versionCheck s;
+    hostNet.mfln = 1024;
+    CHECK(s.begin("https://192.168.15.14/esp-dmx-release.txt", WEEK, &tls));
+    CHECK(run(&s, 100) == VERSION_CHANGED);
+    CHECK(hostNet.probes == 2);
+    CHECK(hostNet.rxBuffer == 1024);
+    CHECK(tls.mfln("192.168.15.14", 443) == 1024);
+    CHECK(!tls.busy());
+    s.start(hostMillis);
+    CHECK(run(&s, 100) == VERSION_UNCHANGED);
+    CHECK(hostNet.probes == 2);
+    CHECK(hostNet.resumed == 1);
+
+    return checkDone("test_version_check");
+}
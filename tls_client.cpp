@@ -0,0 +1,170 @@
+/*
+ * One BearSSL client for all HTTPS requests of the node
+ */
+
+#include "tls_client.h"
+
+tlsClient::tlsClient() {
+    this->secure = NULL;
+    this->inUse = false;
+    for (int i = 0; i < TLS_HOSTS; i++) {
+        this->hosts[i].port = 0;
+        this->hosts[i].mfln = 0;
+        this->hosts[i].probing = TLS_MFLN_MIN;
+    }
+    this->oldest = 0;
+    this->lastHandshake = 0;
+    this->lastHeap = 0;
+    this->count = 0;
+}
+
+/*
+ * Entry of a host, with add a new one replaces the oldest
+ */
+tlsHost *tlsClient::find(const String &host, uint16_t port, bool add) {
+    for (int i = 0; i < TLS_HOSTS; i++) {
+        if ((this->hosts[i].port == port) && (this->hosts[i].host == host)) return &this->hosts[i];
+    }
+    if (!add) return NULL;
+    tlsHost *h = &this->hosts[this->oldest];
+    this->oldest = (this->oldest + 1) % TLS_HOSTS;
+    h->host = host;
+    h->port = port;
+    h->mfln = 0;
+    h->probing = TLS_MFLN_MIN;
+    h->session = BearSSL::Session();
+    return h;
+}
+
+/*
+ * Find the fragment length of a host, one probe per call
+ * A failed probe only counts as an answer when the host takes a plain
+ * TCP connection, otherwise the probing starts over on the next call
+ */
+int tlsClient::probe(const String &host, uint16_t port) {
+    tlsHost *h = this->find(host, port, true);
+    if (h->mfln != 0) return TLS_PROBE_DONE;
+    if (BearSSL::WiFiClientSecure::probeMaxFragmentLength(host, port, h->probing)) {
+        h->mfln = h->probing;
+        return TLS_PROBE_DONE;
+    }
+    WiFiClient tcp;
+    tcp.setTimeout(TLS_PROBE_TIMEOUT);
+    if (!tcp.connect(host.c_str(), port)) {
+        h->probing = TLS_MFLN_MIN;
+        return TLS_PROBE_FAILED;
+    }
+    tcp.stop();
+    if (h->probing >= TLS_MFLN_MAX) {
+        Serial.printf("ESP-DMX: %s does not support MFLN, may get buffer overflow\n", host.c_str());
+        h->mfln = -1;
+        return TLS_PROBE_DONE;
+    }
+    h->probing *= 2;
+    return TLS_PROBE_MORE;
+}
+
+/*
+ * The client, set up for a host, not connected
+ * Buffers sized by the fragment length and the session of the last connection
+ * NULL while another user holds it, the caller holds it until release()
+ */
+BearSSL::WiFiClientSecure *tlsClient::client(const String &host, uint16_t port) {
+    if (this->inUse) return NULL;
+    if (this->secure == NULL) this->secure = new BearSSL::WiFiClientSecure();
+    tlsHost *h = this->find(host, port, true);
+    this->secure->stop();
+    this->secure->setInsecure();
+    this->secure->setBufferSizes((h->mfln > 0) ? h->mfln : TLS_BUFFER_DEFAULT, TLS_TX_BUFFER);
+    this->secure->setSession(&h->session);
+    this->inUse = true;
+    return this->secure;
+}
+
+/*
+ * Done with the client, stops the connection
+ */
+void tlsClient::release() {
+    if (this->secure) this->secure->stop();
+    this->inUse = false;
+}
+
+bool tlsClient::busy() {
+    return this->inUse;
+}
+
+/*
+ * Connect to a host, NULL when that failed or the client is busy
+ */
+BearSSL::WiFiClientSecure *tlsClient::connect(const String &host, uint16_t port, uint32_t timeout) {
+    BearSSL::WiFiClientSecure *c = this->client(host, port);
+    if (c == NULL) return NULL;
+    c->setTimeout(timeout);
+    uint32_t heap = ESP.getFreeHeap();
+    uint32_t start = millis();
+    if (!c->connect(host.c_str(), port)) {
+        char error[80];
+        int e = c->getLastSSLError(error, sizeof(error));
+        Serial.printf("ESP-DMX: TLS connect to %s failed, %d %s\n", host.c_str(), e, error);
+        this->release();
+        return NULL;
+    }
+    this->lastHandshake = millis() - start;
+    this->lastHeap = heap - ESP.getFreeHeap();
+    this->count++;
+    return c;
+}
+
+/*
+ * Fragment length cached for a host, 0 when unknown, -1 when not supported
+ */
+int tlsClient::mfln(const String &host, uint16_t port) {
+    tlsHost *h = this->find(host, port, false);
+    return (h == NULL) ? 0 : h->mfln;
+}
+
+/*
+ * ms the last handshake took, a resumed session is much faster
+ */
+uint32_t tlsClient::handshakeTime() {
+    return this->lastHandshake;
+}
+
+/*
+ * Heap taken by the last connection, buffers and TLS state
+ */
+uint32_t tlsClient::heapUsed() {
+    return this->lastHeap;
+}
+
+uint32_t tlsClient::handshakes() {
+    return this->count;
+}
+
+/*
+ * Split http(s)://host[:port]/path
+ */
+bool parseUrl(const String &url, bool *https, String *host, uint16_t *port, String *path) {
+    int hostStart;
+    if (url.startsWith("https://")) {
+        *https = true;
+        *port = 443;
+        hostStart = 8;
+    } else if (url.startsWith("http://")) {
+        *https = false;
+        *port = 80;
+        hostStart = 7;
+    } else {
+        return false;
+    }
+    int pathStart = url.indexOf('/', hostStart);
+    if (pathStart < 0) return false;
+    *host = url.substring(hostStart, pathStart);
+    *path = url.substring(pathStart);
+    int colon = host->indexOf(':');
+    if (colon >= 0) {
+        *port = host->substring(colon + 1).toInt();
+        host->remove(colon);
+    }
+    return true;
+}
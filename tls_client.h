@@ -0,0 +1,71 @@
+/*
+ * One BearSSL client for all HTTPS requests of the node
+ *
+ * The client is kept between requests. Per host it remembers the TLS
+ * fragment length the server accepted (MFLN, so the buffers can be small)
+ * and the TLS session, so the next connect can resume it instead of a full
+ * handshake. Handshake time and the heap taken by the connection are
+ * measured for every connect.
+ *
+ * Only one connection at a time: the user that connected holds the client
+ * until release(), until then client() and connect() return NULL instead
+ * of stopping it. A probe that cannot reach the host is not cached, only
+ * answers of the server are.
+ */
+
+#ifndef _TLS_CLIENT_H_
+#define _TLS_CLIENT_H_
+
+#include <Arduino.h>
+#include <WiFiClientSecureBearSSL.h>
+
+#define TLS_HOSTS 2           // hosts remembered
+#define TLS_MFLN_MIN 512
+#define TLS_MFLN_MAX 4096
+#define TLS_BUFFER_DEFAULT 1024   // receive buffer when the server knows no MFLN
+#define TLS_TX_BUFFER 512
+#define TLS_PROBE_TIMEOUT 2000    // ms, connect when the host did not take a probe
+
+enum {
+    TLS_PROBE_MORE,           // call again for the next fragment length
+    TLS_PROBE_DONE,           // fragment length known, see mfln()
+    TLS_PROBE_FAILED,         // host not reachable, nothing cached
+};
+
+struct tlsHost {
+    String host;
+    uint16_t port;
+    int16_t mfln;             // accepted fragment length, 0 = not probed yet, -1 = not supported
+    int16_t probing;          // fragment length to probe next
+    BearSSL::Session session;
+};
+
+class tlsClient {
+    public:
+        tlsClient();
+
+        int probe(const String &host, uint16_t port);
+        BearSSL::WiFiClientSecure *connect(const String &host, uint16_t port, uint32_t timeout);
+        BearSSL::WiFiClientSecure *client(const String &host, uint16_t port);
+        void release();
+        bool busy();
+        int mfln(const String &host, uint16_t port);
+        uint32_t handshakeTime();
+        uint32_t heapUsed();
+        uint32_t handshakes();
+
+    private:
+        BearSSL::WiFiClientSecure *secure;
+        bool inUse;
+        tlsHost hosts[TLS_HOSTS];
+        int oldest;
+        uint32_t lastHandshake;
+        uint32_t lastHeap;
+        uint32_t count;
+
+        tlsHost *find(const String &host, uint16_t port, bool add);
+};
+
+bool parseUrl(const String &url, bool *https, String *host, uint16_t *port, String *path);
+
+#endif
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+#
+# Compile the HTML templates into html_pages.h, see build-notes
+#
+#   tools/html2progmem.py html/*.html > html_pages.h
+#
+# {{name}} in a template is a slot filled by the function html_name(),
+# which the sketch has to provide.
+
+import os
+import re
+import sys
+
+SLOT = re.compile(r'\{\{(\w+)\}\}')
+
+
+def c_string(text):
+    lines = []
+    for line in text.splitlines(True):
+        line = line.replace('\\', '\\\\').replace('"', '\\"').replace('\n', '\\n')
+        lines.append('    "' + line + '"')
+    return '\n'.join(lines) if lines else '    ""'
+
+
+def compile_template(path):
+    name = os.path.splitext(os.path.basename(path))[0]
+    with open(path) as f:
+        source = f.read()
+    text = ''
+    slots = []
+    pos = 0
+    for m in SLOT.finditer(source):
+        text += source[pos:m.start()]
+        slots.append((len(text.encode()), m.group(1)))
+        pos = m.end()
+    text += source[pos:]
+    return name, text, slots
+
+
+def main(paths):
+    templates = [compile_template(p) for p in paths]
+    getters = sorted(set(slot for _, _, slots in templates for _, slot in slots))
+
+    out = []
+    out.append('/*')
+    out.append(' * Compiled HTML templates, generated by tools/html2progmem.py from')
+    out.append(' * ' + ' '.join(paths))
+    out.append(' * Do not edit, change the templates and run it again')
+    out.append(' */')
+    out.append('')
+    out.append('#ifndef _HTML_PAGES_H_')
+    out.append('#define _HTML_PAGES_H_')
+    out.append('')
+    out.append('#include "html_template.h"')
+    out.append('')
+    for g in getters:
+        out.append('void html_%s();' % g)
+    for name, text, slots in templates:
+        out.append('')
+        out.append('const char PROGMEM html_%s_text[] =' % name)
+        out.append(c_string(text) + ';')
+        if slots:
+            out.append('const htmlSlot PROGMEM html_%s_slots[] = {' % name)
+            for offset, slot in slots:
+                out.append('    { %d, html_%s },' % (offset, slot))
+            out.append('};')
+            out.append('const htmlTemplate PROGMEM html_%s = { html_%s_text, %d, html_%s_slots, %d };'
+                       % (name, name, len(text.encode()), name, len(slots)))
+        else:
+            out.append('const htmlTemplate PROGMEM html_%s = { html_%s_text, %d, NULL, 0 };'
+                       % (name, name, len(text.encode())))
+    out.append('')
+    out.append('#endif')
+    print('\n'.join(out))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.exit('usage: html2progmem.py template.html ...')
+    main(sys.argv[1:])
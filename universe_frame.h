@@ -0,0 +1,24 @@
+/*
+ * One universe frame as passed between the receivers and the outputs
+ *
+ * Kept apart from esp-dmx.h, which has the Arduino configuration, so the
+ * frame handling modules build on a host as well.
+ */
+
+#ifndef _UNIVERSE_FRAME_H_
+#define _UNIVERSE_FRAME_H_
+
+#include <stdint.h>
+
+#define DMX_SLOTS 512         // maximum number of channels in a frame
+
+// One universe frame, see dmx_frames.h for the buffering
+struct globalStruct {
+    uint16_t universe;
+    uint16_t length;
+    uint8_t sequence;
+    uint32_t source;    // IPv4 address of the sender, network order
+    uint8_t *data;
+} ;
+
+#endif
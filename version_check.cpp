@@ -0,0 +1,186 @@
+/*
+ * Firmware version check, without blocking loop()
+ */
+
+#include "version_check.h"
+
+versionCheck::versionCheck() {
+    this->port = 80;
+    this->https = false;
+    this->interval = 0;
+    this->due = 0;
+    this->started = 0;
+    this->step = VERSION_IDLE;
+    this->code = 0;
+    this->failCount = 0;
+    this->etag[0] = 0;
+    this->lastModified[0] = 0;
+    this->tls = NULL;
+    this->client = &this->plain;
+}
+
+/*
+ * Set the URL of the release file and the interval between checks
+ * The first check is due right away
+ */
+bool versionCheck::begin(const String &url, uint32_t interval, tlsClient *tls) {
+    if (!parseUrl(url, &this->https, &this->host, &this->port, &this->path)) return false;
+    this->tls = tls;
+    this->interval = interval;
+    this->etag[0] = 0;
+    this->lastModified[0] = 0;
+    this->step = VERSION_IDLE;
+    this->due = millis();
+    return true;
+}
+
+/*
+ * Check at the next poll(), unless a check is running
+ */
+void versionCheck::start(uint32_t now) {
+    if (this->step == VERSION_IDLE) this->due = now;
+}
+
+/*
+ * Do the next bit of the check
+ * Returns VERSION_NONE while nothing is finished
+ */
+int versionCheck::poll(uint32_t now) {
+    if ((this->step != VERSION_IDLE) && (now - this->started > VERSION_TIMEOUT)) {
+        return this->fail(now, -1);
+    }
+
+    switch (this->step) {
+        case VERSION_IDLE:
+            if ((int32_t)(now - this->due) < 0) return VERSION_NONE;
+            this->started = now;
+            this->code = 0;
+            this->client = &this->plain;
+            this->step = this->https ? VERSION_PROBE : VERSION_CONNECT;
+            return VERSION_NONE;
+
+        case VERSION_PROBE:
+            // one fragment length per pass, each probe is a round trip, known hosts need none
+            switch (this->tls->probe(this->host, this->port)) {
+                case TLS_PROBE_DONE:
+                    this->step = VERSION_CONNECT;
+                    break;
+                case TLS_PROBE_FAILED:
+                    return this->fail(now, -1);
+            }
+            return VERSION_NONE;
+
+        case VERSION_CONNECT:
+            if (this->https) {
+                if (this->tls->busy()) return VERSION_NONE;    // an update holds it, wait
+                this->client = this->tls->connect(this->host, this->port, VERSION_CONNECT_TIMEOUT);
+                if (this->client == NULL) {
+                    this->client = &this->plain;
+                    return this->fail(now, -1);
+                }
+            } else {
+                this->plain.setTimeout(VERSION_CONNECT_TIMEOUT);
+                if (!this->plain.connect(this->host.c_str(), this->port)) return this->fail(now, -1);
+            }
+            this->step = VERSION_REQUEST;
+            return VERSION_NONE;
+
+        case VERSION_REQUEST: {
+            char request[VERSION_REQUEST_MAX];
+            int length = httpRequest(request, sizeof(request), this->host.c_str(), this->path.c_str(), this->etag, this->lastModified);
+            if (length < 0) return this->fail(now, -1);
+            this->client->write((const uint8_t *)request, length);
+            this->response.begin();
+            this->step = VERSION_RECEIVE;
+            return VERSION_NONE;
+        }
+
+        case VERSION_RECEIVE: {
+            int avail = this->client->available();
+            if (avail <= 0) {
+                if (!this->client->connected()) return this->finish(now);
+                return VERSION_NONE;
+            }
+            uint8_t buf[VERSION_READ_CHUNK];
+            int n = this->client->read(buf, min(avail, (int)sizeof(buf)));
+            if (n > 0) this->response.feed(buf, n);
+            if (this->response.headDone() && (this->response.code() == 304)) return this->finish(now);   // no body to wait for
+            return VERSION_NONE;
+        }
+    }
+    return VERSION_NONE;
+}
+
+/*
+ * Stop the connection, the TLS client is free for others again
+ */
+void versionCheck::close() {
+    if (this->client == &this->plain) {
+        this->plain.stop();
+    } else {
+        this->tls->release();
+        this->client = &this->plain;
+    }
+}
+
+/*
+ * The server closed the connection, look at what came in
+ */
+int versionCheck::finish(uint32_t now) {
+    this->close();
+    this->step = VERSION_IDLE;
+    this->code = this->response.code();
+    if (this->code == 0) this->code = -1;     // closed before the status line
+    if (this->code == 304) {
+        this->failCount = 0;
+        this->due = now + this->interval;
+        return VERSION_UNCHANGED;
+    }
+    if (this->code != 200) return this->fail(now, this->code);
+    if (!this->response.complete()) return this->fail(now, -1);    // cut off, the file may be half of it
+    strcpy(this->etag, this->response.etag());
+    strcpy(this->lastModified, this->response.lastModified());
+    this->failCount = 0;
+    this->due = now + this->interval;
+    return VERSION_CHANGED;
+}
+
+/*
+ * Give up this check, the next one waits twice as long as the last
+ */
+int versionCheck::fail(uint32_t now, int code) {
+    this->close();
+    this->step = VERSION_IDLE;
+    this->code = code;
+    if (this->failCount < 16) this->failCount++;
+    uint32_t wait = (uint32_t)VERSION_RETRY << min(this->failCount - 1, (uint32_t)8);
+    if (wait > VERSION_BACKOFF_MAX) wait = VERSION_BACKOFF_MAX;
+    this->due = now + wait;
+    return VERSION_FAILED;
+}
+
+int versionCheck::state() {
+    return this->step;
+}
+
+/*
+ * HTTP status of the last check, -1 for connection errors and timeouts
+ */
+int versionCheck::httpCode() {
+    return this->code;
+}
+
+const char *versionCheck::body() {
+    return this->response.body();
+}
+
+/*
+ * Failed checks in a row
+ */
+uint32_t versionCheck::failures() {
+    return this->failCount;
+}
+
+uint32_t versionCheck::nextCheck() {
+    return this->due;
+}
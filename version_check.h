@@ -0,0 +1,90 @@
+/*
+ * Firmware version check, without blocking loop()
+ *
+ * The release file on the update server is fetched by a state machine that
+ * does a bit of work per call of poll(): connect, send the request, read
+ * what has arrived. The request is conditional, with the ETag and
+ * Last-Modified of the previous answer, so an unchanged file costs a 304
+ * without body. A 200 whose body ends before its Content-Length is a
+ * failed check, not a new release file. Failed checks are retried after
+ * VERSION_RETRY, doubling up to VERSION_BACKOFF_MAX.
+ * Request and response go through fixed buffers, see http_response.h.
+ *
+ * The connect itself still blocks: DNS, the TCP and the TLS handshake
+ * take up to VERSION_CONNECT_TIMEOUT, and so does each fragment length
+ * probe. Neither the core's WiFiClient nor BearSSL can connect in the
+ * background, and a stall that long runs the DMA ring of the I2S port
+ * (25 ms ahead) dry, so the check runs rarely: once a week
+ * (VERSIONCHECKINTERVAL) and on request from the update page. HTTPS goes
+ * through the shared tlsClient, the fragment length probe is done once per
+ * host, a step per call. The check holds the client from the connect
+ * until it is finished.
+ */
+
+#ifndef _VERSION_CHECK_H_
+#define _VERSION_CHECK_H_
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include "tls_client.h"
+#include "http_response.h"
+
+#define VERSION_CONNECT_TIMEOUT 2000    // ms, TCP connect and TLS handshake
+#define VERSION_TIMEOUT 10000           // ms, whole request
+#define VERSION_READ_CHUNK 256          // bytes read per poll()
+#define VERSION_REQUEST_MAX 256         // bytes of the request
+#define VERSION_RETRY 60000             // ms, wait after the first failed check
+#define VERSION_BACKOFF_MAX 3600000     // ms, longest wait after errors
+
+enum {
+    VERSION_IDLE,
+    VERSION_PROBE,        // https: find a TLS fragment length the server accepts
+    VERSION_CONNECT,
+    VERSION_REQUEST,
+    VERSION_RECEIVE,
+};
+
+enum {
+    VERSION_NONE,         // nothing new
+    VERSION_CHANGED,      // release file received, see body()
+    VERSION_UNCHANGED,    // 304, release file as before
+    VERSION_FAILED,       // see httpCode(), retried after a back-off
+};
+
+class versionCheck {
+    public:
+        versionCheck();
+
+        bool begin(const String &url, uint32_t interval, tlsClient *tls);
+        void start(uint32_t now);
+        int poll(uint32_t now);
+        int state();
+        int httpCode();
+        const char *body();
+        uint32_t failures();
+        uint32_t nextCheck();
+
+    private:
+        String host;
+        String path;
+        uint16_t port;
+        bool https;
+        uint32_t interval;
+        uint32_t due;
+        uint32_t started;
+        int step;
+        int code;
+        uint32_t failCount;
+        char etag[HTTP_VALIDATOR_MAX];
+        char lastModified[HTTP_VALIDATOR_MAX];
+        httpResponse response;
+        WiFiClient plain;
+        tlsClient *tls;
+        WiFiClient *client;
+
+        int finish(uint32_t now);
+        int fail(uint32_t now, int code);
+        void close();
+};
+
+#endif
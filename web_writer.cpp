@@ -0,0 +1,136 @@
+/*
+ * Streamed HTTP responses
+ */
+
+#include "web_writer.h"
+
+webWriter::webWriter(ESP8266WebServer &server, void (*yield)(void)) : server(server) {
+    this->yield = yield;
+    this->used = 0;
+    this->bytes = 0;
+    this->started = 0;
+    this->firstChunk = 0;
+    this->heapMin = 0;
+    memset(&this->figures, 0, sizeof(this->figures));
+}
+
+/*
+ * Send the status line and headers, the length is not known up front
+ */
+void webWriter::begin(int code, const char *type) {
+    this->used = 0;
+    this->bytes = 0;
+    this->firstChunk = 0;
+    this->started = micros();
+    this->heapMin = ESP.getFreeHeap();
+    this->server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    this->server.send(code, type, "");
+}
+
+/*
+ * Send the last chunk and keep the figures of this response
+ */
+void webWriter::end() {
+    this->flush();
+    this->server.sendContent("");
+    this->figures.bytes = this->bytes;
+    this->figures.firstChunk = this->firstChunk;
+    this->figures.total = micros() - this->started;
+    this->figures.heapMin = this->heapMin;
+}
+
+/*
+ * Figures of the last response sent through the writer
+ */
+webFigures webWriter::last() {
+    return this->figures;
+}
+
+/*
+ * Send what is in the buffer as one chunk
+ */
+void webWriter::flush() {
+    if (this->used == 0) return;
+    this->server.sendContent(this->buffer, this->used);
+    this->bytes += this->used;
+    this->used = 0;
+    this->sent();
+}
+
+// bookkeeping after each chunk, then the realtime work gets its turn
+void webWriter::sent() {
+    if (this->firstChunk == 0) this->firstChunk = micros() - this->started;
+    uint32_t heap = ESP.getFreeHeap();
+    if (heap < this->heapMin) this->heapMin = heap;
+    if (this->yield) this->yield();
+}
+
+size_t webWriter::write(uint8_t c) {
+    if (this->used >= WEB_BUFFER) this->flush();
+    this->buffer[this->used++] = c;
+    return 1;
+}
+
+size_t webWriter::write(const uint8_t *data, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        if (this->used >= WEB_BUFFER) this->flush();
+        size_t n = min(len - done, WEB_BUFFER - this->used);
+        memcpy(this->buffer + this->used, data + done, n);
+        this->used += n;
+        done += n;
+    }
+    return len;
+}
+
+/*
+ * F() fragment
+ */
+size_t webWriter::print(const __FlashStringHelper *s) {
+    PGM_P p = reinterpret_cast<PGM_P>(s);
+    return this->writeFlash(p, strlen_P(p));
+}
+
+/*
+ * len bytes of text in flash, copied into the buffer when short, else sent from flash
+ */
+size_t webWriter::writeFlash(PGM_P p, size_t len) {
+    if (len < WEB_BUFFER / 2) {
+        if (this->used + len > WEB_BUFFER) this->flush();
+        memcpy_P(this->buffer + this->used, p, len);
+        this->used += len;
+        return len;
+    }
+    this->flush();
+    this->server.sendContent_P(p, len);
+    this->bytes += len;
+    this->sent();
+    return len;
+}
+
+/*
+ * Format into the free part of the buffer, flushing first when it does not fit
+ */
+size_t webWriter::printf(const char *format, ...) {
+    va_list args;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        va_start(args, format);
+        int n = vsnprintf(this->buffer + this->used, WEB_BUFFER - this->used, format, args);
+        va_end(args);
+        if (n < 0) return 0;
+        if ((size_t)n < WEB_BUFFER - this->used) {
+            this->used += n;
+            return n;
+        }
+        this->flush();
+    }
+    // longer than the whole buffer, formatted on the heap
+    char *text = (char *)malloc(WEB_BUFFER * 4);
+    if (text == NULL) return 0;
+    va_start(args, format);
+    int n = vsnprintf(text, WEB_BUFFER * 4, format, args);
+    va_end(args);
+    size_t len = this->write((const uint8_t *)text, min((size_t)n, (size_t)(WEB_BUFFER * 4 - 1)));
+    free(text);
+    return len;
+}
@@ -0,0 +1,60 @@
+/*
+ * Streamed HTTP responses
+ *
+ * Pages are written into a small fixed buffer that goes out as a chunk of
+ * a chunked transfer-encoding response whenever it is full, instead of
+ * being assembled in a String first. F() fragments longer than half the
+ * buffer are sent straight from flash, numbers and printf() are formatted
+ * in place in the buffer. Between chunks the yield function runs, see
+ * taskScheduler::runTasks().
+ *
+ * Of every response the size, time to the first chunk, total time and
+ * the lowest free heap seen while it was sent are kept, see last().
+ */
+
+#ifndef _WEB_WRITER_H_
+#define _WEB_WRITER_H_
+
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+
+#define WEB_BUFFER 512
+
+struct webFigures {
+    uint32_t bytes;
+    uint32_t firstChunk;    // us from begin() to the first chunk
+    uint32_t total;         // us from begin() to end()
+    uint32_t heapMin;       // lowest free heap while sending
+};
+
+class webWriter : public Print {
+    public:
+        webWriter(ESP8266WebServer &server, void (*yield)(void));
+
+        void begin(int code, const char *type);
+        void end();
+        void flush();
+
+        size_t write(uint8_t c);
+        size_t write(const uint8_t *data, size_t len);
+        using Print::print;
+        size_t print(const __FlashStringHelper *s);
+        size_t writeFlash(PGM_P text, size_t len);
+        size_t printf(const char *format, ...) __attribute__ ((format (printf, 2, 3)));
+        webFigures last();
+
+    private:
+        ESP8266WebServer &server;
+        void (*yield)(void);
+        char buffer[WEB_BUFFER];
+        size_t used;
+        uint32_t bytes;
+        uint32_t started;       // us
+        uint32_t firstChunk;    // us after started, 0 before the first chunk
+        uint32_t heapMin;
+        webFigures figures;     // of the last response
+
+        void sent();
+};
+
+#endif
@@ -19,6 +19,26 @@
 #include "dmx512.h"
 #include "statusLED.h"
 #include "esp-dmx.h"
+#include "dmx_frames.h"
+#include "dmx_output.h"
+#include "dmx_i2s.h"
+#include "send_break.h"
+#include "route_table.h"
+#include "sacn.h"
+#include "dmx_merge.h"
+#include "artnet_sync.h"
+#include "artnet_seq.h"
+#include "source_stats.h"
+#include "artnet_pollreply.h"
+#include "loop_profile.h"
+#include "task_scheduler.h"
+#include "version_check.h"
+#include "tls_client.h"
+#include "web_writer.h"
+#include "html_pages.h"
+#include "api_status.h"
+#include "metrics.h"
+#include "monitor.h"
 
 //#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
 //#include <esp_log.h>
@@ -35,14 +55,31 @@ extern char * status_text[];
 extern unsigned long packetCounter;
 extern unsigned long dmxUMatchCounter;
 extern unsigned long artnetPacketCounter;
+extern unsigned long artnetAccepted;
+extern unsigned long artnetCoalesced;
+extern unsigned long artnetDropped;
 extern uint16_t seen_universe;
 extern long dmxskip;
 extern int last_rssi;
 extern void powerOnShow(int,int);
-extern globalStruct global;
+extern int portUniverse(int);
+extern frameBuffer global[];
+extern dmxI2sOutput dmx2;
+extern int dmxPorts;
+extern routeTable routes;
+extern taskScheduler scheduler;
+extern sacnReceiver sacn;
+extern dmxMerge merge[];
+extern artnetSync artsync;
+extern seqTracker sequence;
+extern sourceStats senders;
+extern artnetPollReply pollReply;
+extern bool buildRoutes();
 extern int temperature;
 extern int fanspeed;
-extern int dmxFrameCounter;
+extern unsigned long dmxFrameCounter;
+extern dmxOutput dmx;
+extern unsigned long dmxFps[2];
 extern long micros_dmxsend;
 bool newFwAvailable;
 String newFwURL;
@@ -56,6 +93,9 @@ int new_minor = 0;
  */
 void defaultConfig() {
     config.universe = 0;
+    config.universe2 = 1;
+    config.routes = "";
+    config.ports = 1;
     config.channels = 512;
     config.delay = 30;
     config.holdsecs = 30;
@@ -64,6 +104,10 @@ void defaultConfig() {
     config.fwURL = "http://"+WiFi.gatewayIP(); config.fwURL += "/";
     config.pOnShowCh1 = 0;
     config.pOnShowNumCh = 1;
+    config.breakus = DMX_BREAK_DEFAULT;
+    config.mabus = DMX_MAB_DEFAULT;
+    config.shortFrames = 0;
+    config.mergeMode = MERGE_HTP;
 }
 
 
@@ -98,12 +142,19 @@ bool loadConfig() {
     }
     if (jsonDoc.containsKey("hostname")) { String hn = jsonDoc["hostname"]; config.hostname = hn; };
     if (jsonDoc.containsKey("universe")) { config.universe = jsonDoc["universe"]; } 
+    if (jsonDoc.containsKey("universe2")) { config.universe2 = jsonDoc["universe2"]; } 
+    if (jsonDoc.containsKey("routes")) { String rt = jsonDoc["routes"]; config.routes = rt; } else { config.routes = ""; }
+    if (jsonDoc.containsKey("ports")) { config.ports = jsonDoc["ports"]; } else { config.ports = 1; }
     if (jsonDoc.containsKey("channels")) { config.channels = jsonDoc["channels"]; } 
     if (jsonDoc.containsKey("delay")) { config.delay = jsonDoc["delay"]; } 
     if (jsonDoc.containsKey("holdsecs")) { config.holdsecs = jsonDoc["holdsecs"]; } 
     if (jsonDoc.containsKey("fwURL")) { String fw = jsonDoc["fwURL"]; config.fwURL = fw; } 
     if (jsonDoc.containsKey("pOnShowCh1")) { config.pOnShowCh1 = jsonDoc["pOnShowCh1"]; } 
     if (jsonDoc.containsKey("pOnShowNumCh")) { config.pOnShowNumCh = jsonDoc["pOnShowNumCh"]; } 
+    if (jsonDoc.containsKey("breakus")) { config.breakus = jsonDoc["breakus"]; } else { config.breakus = DMX_BREAK_DEFAULT; }
+    if (jsonDoc.containsKey("mabus")) { config.mabus = jsonDoc["mabus"]; } else { config.mabus = DMX_MAB_DEFAULT; }
+    if (jsonDoc.containsKey("shortFrames")) { config.shortFrames = jsonDoc["shortFrames"]; } 
+    if (jsonDoc.containsKey("mergeMode")) { config.mergeMode = jsonDoc["mergeMode"]; } else { config.mergeMode = MERGE_HTP; }
     return true;
 }
 
@@ -113,16 +164,23 @@ bool loadConfig() {
  */
 bool saveConfig() {
     Serial.println("saveConfig: ");
-    DynamicJsonDocument jsonDoc(500);
+    DynamicJsonDocument jsonDoc(1024);
   
     jsonDoc["hostname"] = config.hostname;
     jsonDoc["universe"] = config.universe;
+    jsonDoc["universe2"] = config.universe2;
+    jsonDoc["routes"] = config.routes;
+    jsonDoc["ports"] = config.ports;
     jsonDoc["channels"] = config.channels;
     jsonDoc["delay"] = config.delay;
     jsonDoc["holdsecs"] = config.holdsecs;
     jsonDoc["fwURL"] = config.fwURL;
     jsonDoc["pOnShowCh1"] = config.pOnShowCh1;
     jsonDoc["pOnShowNumCh"] = config.pOnShowNumCh;
+    jsonDoc["breakus"] = config.breakus;
+    jsonDoc["mabus"] = config.mabus;
+    jsonDoc["shortFrames"] = config.shortFrames;
+    jsonDoc["mergeMode"] = config.mergeMode;
   
     File configFile = SPIFFS.open("/config.json", "w");
     if (!configFile) {
@@ -139,37 +197,98 @@ bool saveConfig() {
 
 
 /*
- * Assemble the common html header string
+ * Pages, for the header
  */
 #define PAGE_INDEX 1
 #define PAGE_CONFIG 2
 #define PAGE_RESTART 3
 #define PAGE_UPDATE 4
 #define PAGE_RESTART 5
-String http_head(int pageid) {
-    String head =  F("<head><title>"); head += config.hostname; head += F("</title>");
-    if (pageid == PAGE_RESTART) { head += F("<meta http-equiv='refresh' content='20;url=/'></head>\n"); } else { head += F("</head>\n"); }
-           head += F("<body><h1 style='text-align: center;'>"); head += config.hostname; head += F("</h1>\n");
-           head += F("<table style='width:100%;border: 1px solid black; text-align: center;'>\n<tr>");
-    if (pageid == PAGE_INDEX)   { head += F("<td><b>Home</b></td>"); }    else { head += F("<td><a href='/'>Home</a></td>"); }
-    if (pageid == PAGE_CONFIG)  { head += F("<td><b>Config</b></td>"); }  else { head += F("<td><a href='/config'>Config</a></td>"); }
-    if (pageid == PAGE_RESTART) { head += F("<td><b>Restart</b></td>"); } else { head += F("<td><a href='/restart'>Restart</a></td>"); }
-    if (pageid == PAGE_UPDATE)  { head += F("<td><b>Update</b></td>"); }  else { head += F("<td><a href='/update'>Update</a></td>"); }
-           head += F("</tr>\n</table>\n");
+#define PAGE_MONITOR 6
 
-    return head;
+/*
+ * Every page is streamed through this writer, see web_writer.h
+ * The due DMX and Art-Net tasks run after each chunk
+ */
+void webYield() {
+    scheduler.runTasks();
 }
 
+webWriter page(webServer, webYield);
+
+void webSpan(PGM_P text, size_t len) {
+    page.writeFlash(text, len);
+}
 
 /*
- * Assemble the common html footer string
+ * Live channel monitor, see monitor.h
+ * Started from setup(), served by a housekeeping job
  */
+dmxMonitor monitor(webYield);
+
+void monitorBegin() {
+    monitor.begin(global, dmxPorts);
+}
 
-String http_foot() {
-    String foot =  F("<p><hr style='width:100%; height:1px; border:none; color:red; background:black;'>\n");
-           foot += F("<p>ESP-DMX by Markus Baertschi, <a href=https://github.com/markusb>github.com/markusb/esp-dmx</a>\n");
-           foot += F("</body>\n");
-    return foot;
+void monitorHandle() {
+    monitor.handle();
+}
+
+/*
+ * Slots of the templates in html/, see html_pages.h
+ */
+int htmlPageId;
+
+void html_hostname()     { page.print(config.hostname); }
+void html_universe()     { page.print(config.universe); }
+void html_ports()        { page.print(config.ports); }
+void html_universe2()    { page.print(config.universe2); }
+void html_routes()       { page.print(config.routes); }
+void html_channels()     { page.print(config.channels); }
+void html_delay()        { page.print(config.delay); }
+void html_holdsecs()     { page.print(config.holdsecs); }
+void html_fwURL()        { page.print(config.fwURL); }
+void html_pOnShowCh1()   { page.print(config.pOnShowCh1); }
+void html_pOnShowNumCh() { page.print(config.pOnShowNumCh); }
+void html_breakus()      { page.print(config.breakus); }
+void html_mabus()        { page.print(config.mabus); }
+void html_shortFrames()  { page.print(config.shortFrames); }
+void html_mergeMode()    { page.print(config.mergeMode); }
+void html_monitorPort()  { page.print(MONITOR_PORT); }
+
+void html_monitorPorts() {
+    for (int port = 1; port <= dmxPorts; port++) {
+        page.print(F("<option>")); page.print(port); page.print(F("</option>"));
+    }
+}
+
+void html_refresh() {
+    if (htmlPageId == PAGE_RESTART) page.print(F("<meta http-equiv='refresh' content='20;url=/'>"));
+}
+
+void html_nav() {
+    if (htmlPageId == PAGE_INDEX)   { page.print(F("<td><b>Home</b></td>")); }    else { page.print(F("<td><a href='/'>Home</a></td>")); }
+    if (htmlPageId == PAGE_MONITOR) { page.print(F("<td><b>Monitor</b></td>")); } else { page.print(F("<td><a href='/monitor'>Monitor</a></td>")); }
+    if (htmlPageId == PAGE_CONFIG)  { page.print(F("<td><b>Config</b></td>")); }  else { page.print(F("<td><a href='/config'>Config</a></td>")); }
+    if (htmlPageId == PAGE_RESTART) { page.print(F("<td><b>Restart</b></td>")); } else { page.print(F("<td><a href='/restart'>Restart</a></td>")); }
+    if (htmlPageId == PAGE_UPDATE)  { page.print(F("<td><b>Update</b></td>")); }  else { page.print(F("<td><a href='/update'>Update</a></td>")); }
+}
+
+/*
+ * Write the common html header
+ */
+void http_head(int pageid) {
+    htmlPageId = pageid;
+    htmlRender(&html_head, webSpan);
+}
+
+
+/*
+ * Write the common html footer
+ */
+
+void http_foot() {
+    htmlRender(&html_foot, webSpan);
 }
 
 
@@ -183,148 +302,105 @@ String http_foot() {
 String fwBaseUrl = (String)FWHOST + (String)FWDIR;
 String fwUpdateStatus;
 String httpsHost;
-#define CORE_DEBUG_LEVEL=5
-using namespace BearSSL;
-bool checkForNewVersion () {
-    char lastSslError[200];
-    HTTPClient httpClient;
-    String versionURL = fwBaseUrl + (String)FWVERSIONFILE;
-    int httpCode = 0;
-    String newFWVersion;
+uint16_t httpsPort;
+bool httpsProbe = false;    // probe the update host, see checkForNewVersion()
+tlsClient tls;              // shared by the version check and online updates
+versionCheck versionChecker;
 
+/*
+ * Start checking for new firmware, every interval ms
+ */
+void versionCheckBegin(uint32_t interval) {
+    String versionURL = fwBaseUrl + (String)FWVERSIONFILE;
     Serial.print("===== checkForNewVersion: URL=");
     Serial.println(versionURL);
     debugstring = "versionURL="+versionURL;
+    if (!versionChecker.begin(versionURL, interval, &tls)) Serial.println("ESP-DMX: version check URL not valid");
+}
+
+/*
+ * Take the version and file name from the release file
+ */
+void releaseInfo(String newFWVersion) {
+    debugstring = "Sucess: "+newFWVersion;
+  
+    Serial.printf( "Current firmware version: %d.%d\n",version_mayor, version_minor);
+
+    // extract version number from downloaded file
+    // Format: Latest-release: x.y
+    int i = newFWVersion.lastIndexOf("Latest-release: ");
+    newFWVersion.remove(0,i);
+    i = newFWVersion.indexOf(".");
+    String sminor = newFWVersion;
+    String smayor = newFWVersion;
+    sminor.remove(0,i+1);   // Remove everything up to the decimal point
+    smayor.remove(i);       // Remove everything including and after the decimal point
+    smayor.remove(0,16);    // Remove the text 'Latest-release: '
+    new_mayor = smayor.toInt();
+    new_minor = sminor.toInt();
+
+    // extract filename from downloaded file
+    // Format: Filename: <filename>
+    i = newFWVersion.lastIndexOf("Filename: ");
+    newFWVersion.remove(0,i);
+    i = newFWVersion.lastIndexOf(" ");
+    int j = newFWVersion.indexOf("\n");
+    newFwURL = (String)FWHOST + (String)FWDIR + newFWVersion.substring(i+1,j); // + newFWVersion + String(i) + String(j);
     
-    if (versionURL.startsWith("https:")) {
-        httpsHost = versionURL.substring(8);
-        int i = httpsHost.indexOf("/");
-        httpsHost.remove(i);
-        debugstring += " host="; debugstring += httpsHost;
-        BearSSL::WiFiClientSecure httpsClient;
-        httpsClient.setInsecure();
-        Serial.printf("Connecting to host %s, port 443\n",httpsHost.c_str());
-        for (i = 512; i <= 4096; i=i*2) {
-            Serial.printf("    Probing for smaller SSL buffer: %d ",i);
-            if (httpsClient.probeMaxFragmentLength(httpsHost,443,i)) {
-                Serial.println("OK");
-                break;
-            } else {
-                Serial.println("Nope");
-            }
-        }
-        if (i == 8196) {
-            Serial.println("    Warning ! MFLN negotation failed, may get buffer overflow");
-        }
-        i=1024;
-        Serial.printf("    Setting buffer size to %d\n",i);
-        httpsClient.setBufferSizes(i,i);
-        int e = httpsClient.connect(httpsHost,443);
-        if (!e) {
-            debugstring += " Connect failed";
-            Serial.print("httpsClient.connect failed with error ");
-            Serial.println(e);
-            e = httpsClient.getLastSSLError(lastSslError,200);
-            Serial.printf("LastSSLError: %d %s\n",e,lastSslError);
-            httpCode = -1;
-            newFwURL = "Failed SSL connect";
-        } else {
-            debugstring = " ssl connetc ok";
-            Serial.printf("ESP free heap: %d\n", ESP.getFreeHeap());
-    //        httpCode = httpsClient.GET();      
-            String getRequest = "GET "; getRequest += FWDIR; getRequest += FWVERSIONFILE; getRequest += " HTTP/1.1\r\nHost: " + httpsHost + "\r\n" + "User-Agent: ESP8266 esp-dmx\r\n\r\n";
-            Serial.println("Sending GET request: "); Serial.println(getRequest);
-            httpsClient.print(getRequest);
-    //        httpsClient.print(String("GET ") + FWVERSIONFILE + " HTTP/1.1\r\n" +
-    //               "Host: " + httpsHost + "\r\n" +          
-    //               "Connection: close\r\n\r\n");
-            httpsClient.flush();
-            Serial.println("Reading returned header");
-            while (httpsClient.connected()) {
-                String line = httpsClient.readStringUntil('\n');
-                Serial.print("    Header: "); Serial.println(line.c_str());
-                //    Header: HTTP/1.1 200 OK
-                if (line.startsWith("HTTP")) {
-                    int i=line.indexOf(" ");
-                    String httpcode = line.substring(i+1,i+4);
-                    httpCode=httpcode.toInt();
-                    Serial.println("    -- Checking for http code: "+httpcode+" "+httpCode);
-                }
-                if (line == "\r") {  // empty line is end of header
-                     break;
-                }
-            }
-    //        newFWVersion = httpsClient.getString();
-            Serial.println("Reading returned data");
-            while(httpsClient.available()) {
-                newFWVersion += httpsClient.readStringUntil('\n');  // Read Line by Line
-//                Serial.println(newFWVersion); // Print response
-            }
-//            httpCode = 200;
-        }
+    debugstring += " smayor="; debugstring += smayor; debugstring += " sminor="; debugstring += sminor;
+    debugstring += " newVers="; debugstring += new_mayor; debugstring += "."; debugstring += new_minor;
+    
+    Serial.printf( "Firmware on server: %d.%d\n",new_mayor, new_minor);
+    if (new_mayor > version_mayor) {
+        newFwAvailable = true;
+    } else if ( new_minor > version_minor ) {
+        newFwAvailable = true;
     } else {
-        // http URL
-        httpClient.begin( versionURL );
-        httpCode = httpClient.GET();
-        newFWVersion = httpClient.getString();
+        newFwAvailable = false;
     }
-    if( httpCode == 200 ) {
-        debugstring += "Sucess: "+newFWVersion;
-      
-        Serial.printf( "Current firmware version: %d.%d\n",version_mayor, version_minor);
-
-        // extract version number from downloaded file
-        // Format: Latest-release: x.y
-        int i = newFWVersion.lastIndexOf("Latest-release: ");
-        newFWVersion.remove(0,i);
-        i = newFWVersion.indexOf(".");
-        String sminor = newFWVersion;
-        String smayor = newFWVersion;
-        sminor.remove(0,i+1);   // Remove everything up to the decimal point
-        smayor.remove(i);       // Remove everything including and after the decimal point
-        smayor.remove(0,16);    // Remove the text 'Latest-release: '
-        new_mayor = smayor.toInt();
-        new_minor = sminor.toInt();
-
-        // extract filename from downloaded file
-        // Format: Filename: <filename>
-        i = newFWVersion.lastIndexOf("Filename: ");
-        newFWVersion.remove(0,i);
-        i = newFWVersion.lastIndexOf(" ");
-        int j = newFWVersion.indexOf("\n");
-        newFwURL = (String)FWHOST + (String)FWDIR + newFWVersion.substring(i+1,j); // + newFWVersion + String(i) + String(j);
-        
-        debugstring += " smayor="; debugstring += smayor; debugstring += " sminor="; debugstring += sminor;
-        debugstring += " newVers="; debugstring += new_mayor; debugstring += "."; debugstring += new_minor;
-        
-        Serial.printf( "Firmware on server: %d.%d\n",new_mayor, new_minor);
-        if (new_mayor > version_mayor) {
-            newFwAvailable = true;
-        } else if ( new_minor > version_minor ) {
-            newFwAvailable = true;
-        } else {
-            newFwAvailable = false;
-        }
-        if (newFwAvailable) {
+    if (newFwAvailable) {
 //            newFwURL = (String)FWHOST + (String)FWDIR + (String)FWBIN; newFwURL += new_mayor; newFwURL+= "."; newFwURL += new_minor; newFwURL += ".bin";
-            debugstring += " new URL="; debugstring += newFwURL;
-            Serial.printf("URL: %s\n",newFwURL.c_str());
-            fwUpdateStatus = "new firmware "+new_mayor;
-            fwUpdateStatus += "."+new_minor;
-            fwUpdateStatus += " availabe at "+newFwURL;
-        } else {
-            fwUpdateStatus = "This the latest version available at "+fwBaseUrl;
-        }
+        debugstring += " new URL="; debugstring += newFwURL;
+        Serial.printf("URL: %s\n",newFwURL.c_str());
+        fwUpdateStatus = "new firmware ";
+        fwUpdateStatus += new_mayor;
+        fwUpdateStatus += ".";
+        fwUpdateStatus += new_minor;
+        fwUpdateStatus += " availabe at "+newFwURL;
+        bool https;
+        String path;
+        httpsProbe = parseUrl(newFwURL, &https, &httpsHost, &httpsPort, &path) && https;
     } else {
-        debugstring += " Error "; debugstring += httpCode; debugstring += " retrieving "; debugstring += (String)FWHOST + (String)FWDIR + (String)FWVERSIONFILE;
+        fwUpdateStatus = "This the latest version available at "+fwBaseUrl;
+    }
+}
+
+/*
+ * Check for new firmware, a bit more of the check on each call
+ * Returns true when an answer of the server came in
+ */
+bool checkForNewVersion () {
+    if (httpsProbe && (versionChecker.state() == VERSION_IDLE)) {
+        // fragment length of the update host, a probe per call, so ota_restart() need not wait for it
+        if (tls.probe(httpsHost, httpsPort) != TLS_PROBE_MORE) httpsProbe = false;
+        return false;
+    }
+    int result = versionChecker.poll(millis());
+    if (result == VERSION_NONE) return false;
+    if (result == VERSION_CHANGED) {
+        releaseInfo(versionChecker.body());
+    } else if (result == VERSION_FAILED) {
+        int httpCode = versionChecker.httpCode();
+        debugstring = "Error "; debugstring += httpCode; debugstring += " retrieving "; debugstring += (String)FWHOST + (String)FWDIR + (String)FWVERSIONFILE;
         fwUpdateStatus  = "Error ";
         fwUpdateStatus += String(httpCode);
         fwUpdateStatus += " checking for new firmware at ";
         fwUpdateStatus += fwBaseUrl;
         Serial.printf("Error %d retrieving ",httpCode);
         Serial.println((String)FWHOST + (String)FWDIR + (String)FWVERSIONFILE);
+        Serial.printf("Next version check in %lu s\n", (unsigned long)(versionChecker.nextCheck() - millis()) / 1000);
     }
-
+    return true;
 }
 
 
@@ -341,7 +417,10 @@ void ota_restart() {
     int updatetype = 0;
     LED.setColor(LED_RED);
 
-    String page = http_head(PAGE_RESTART);
+    webServer.sendHeader("Connection", "close");
+    webServer.sendHeader("Access-Control-Allow-Origin", "*");
+    page.begin(200, "text/html");
+    http_head(PAGE_RESTART);
 
     for (uint8_t i = 0; i < webServer.args(); i++) {
         if (webServer.argName(i) == "updatefile") { updatetype = UPDATE_FILE; }
@@ -349,39 +428,54 @@ void ota_restart() {
     }
 
     if (updatetype == UPDATE_URL) {
-        page += F("<p>Updating from URL: "); page += newFwURL;
+        page.print(F("<p>Updating from URL: ")); page.print(newFwURL);
         
-//        t_httpUpdate_return ret = ESPhttpUpdate.update( (BearSSL::WiFiClientSecure)httpsClient, httpsHost, newFwURL );
         ESPhttpUpdate.rebootOnUpdate(false);
-        t_httpUpdate_return ret = ESPhttpUpdate.update( newFwURL );
+        t_httpUpdate_return ret;
+        bool https;
+        uint16_t port;
+        String path;
+        if (parseUrl(newFwURL, &https, &httpsHost, &port, &path) && https) {
+            // same client, fragment length and session as the version check
+            BearSSL::WiFiClientSecure *client = tls.client(httpsHost, port);
+            if (client == NULL) {
+                page.print(F("<p>The version check is using the connection, try again"));
+                http_foot();
+                page.end();
+                return;
+            }
+            ret = ESPhttpUpdate.update(*client, newFwURL);
+            tls.release();
+        } else {
+            ret = ESPhttpUpdate.update( newFwURL );
+        }
         switch(ret) {
             case HTTP_UPDATE_FAILED:
-                page += F("<p>HTTP_UPDATE_FAILED Error: "); page += ESPhttpUpdate.getLastError();
-                page += F(" Text: "); page += ESPhttpUpdate.getLastErrorString();
+                page.print(F("<p>HTTP_UPDATE_FAILED Error: ")); page.print(ESPhttpUpdate.getLastError());
+                page.print(F(" Text: ")); page.print(ESPhttpUpdate.getLastErrorString());
                 Serial.printf("HTTP_UPDATE_FAILED Error (%d): %s",  ESPhttpUpdate.getLastError(), ESPhttpUpdate.getLastErrorString().c_str());
                 break;
             case HTTP_UPDATE_NO_UPDATES:
-                page += F("<p>HTTP_UPDATE_NO_UPDATES");
+                page.print(F("<p>HTTP_UPDATE_NO_UPDATES"));
                 Serial.println("HTTP_UPDATE_NO_UPDATES");
                 break;
             case HTTP_UPDATE_OK:
-                page += F("<p>HTTP_UPDATE_OK");
+                page.print(F("<p>HTTP_UPDATE_OK"));
                 Serial.println("HTTP_UPDATE_OK");
                 break;
         }
     }
     if (updatetype == UPDATE_FILE) {
         if (Update.hasError()) {
-            page += F("<p>Error: ");
-            page += Update.getError();
+            page.print(F("<p>Error: "));
+            page.print(Update.getError());
         } else {
-            page += F("<p><h1>Upload from file complete - rebooting</h1>");
+            page.print(F("<p><h1>Upload from file complete - rebooting</h1>"));
         }
     }
     
-    webServer.sendHeader("Connection", "close");
-    webServer.sendHeader("Access-Control-Allow-Origin", "*");
-    webServer.send(200, "text/html", page+http_foot());
+    http_foot();
+    page.end();
 
     delay(1000);
     ESP.restart();
@@ -454,42 +548,92 @@ char* IP2String (IPAddress ip) {
 
 /*
  * Assemble the main index and status page
+ * /?reset=1 also restarts the DMX frame statistics, for jitter measurements
  */
 void http_index() {
     Serial.println("HTTP: Sending index page");
-
-    String page = http_head(PAGE_INDEX);
-//    page += F("<p><table style='width:100%; border:1px solid black;'>\n");
-    page += F("<p><table style='width:100%;'>\n");
-    page += F("<tr><td>Hostname:</td><td>"); page += config.hostname; page += F("</td></tr>\n");
-    page += F("<tr><td>Wifi SSID:</td><td>"); page += WiFi.SSID(); page += F("</td></tr>\n");
-    page += F("<tr><td>RSSI (signal strength):</td><td>"); page += last_rssi; page += F("</td></tr>\n");
-    page += F("<tr><td>IP:</td><td>"); page += IP2String(WiFi.localIP()); page += F("</td></tr>\n");
-    page += F("<tr><td>MAC:</td><td>"); page += WiFi.macAddress(); page += F("</td></tr>\n");
-    page += F("<tr><td>ESP-DMX version (build):</td><td>"); page += version_mayor; page += "."; page += version_minor; page += " ("; page += build; page += F(")</td></tr>\n");
-    page += F("<tr><td colspan=2><hr style='width:100%; height:1px; border:none; background:black;'></td><td>");
-    page += F("<tr style='border-top: 1px solid black;'><td>Universe:</td><td>"); page += config.universe; page += F("</td></tr>\n");
-    page += F("<tr><td>Channels:</td><td>"); page += config.channels; page += F("</td></tr>\n");
-    page += F("<tr><td>Delay:</td><td>"); page += config.delay; page += F("</td></tr>\n");
-    page += F("<tr><td>Seconds to hold last frame after signal loss:</td><td>"); page += config.holdsecs; page += "</td></tr>\n";
-    page += F("<tr><td colspan=2><hr style='width:100%; height:1px; border:none; background:black;'></td><td>");
-    page += F("<tr><td>Artnet packets seen:</td><td>"); page += artnetPacketCounter; page += F(" (universe:");
-    page += seen_universe; page += F(")</td></tr>\n");
-    page += F("<tr><td>DMX frames sent:</td><td>"); page += dmxFrameCounter; page += F("</td></tr>\n");
-    page += F("<tr><td>DMX packet length:</td><td>"); page += global.length; page += F(" (channels)</td></tr>\n");
-    page += F("<tr><td>Status:</td><td>"); page += status_text[status], page += F("</td></tr>\n");
-    page += F("<tr style='border-top: 1px solid black;'><td>Device temperature:</td><td>"); page += temperature; page += F("</td></tr>\n");
-    page += F("<tr><td>Fan speed (0-1024):</td><td>"); page += fanspeed; page += F("</td></tr>\n");
-    page += F("<tr><td>Device uptime (s):</td><td>"); page += millis()/1000, page += F("</td></tr>\n");
-//    page += F("<tr><td>DMXloop:</td><td>"); page += dmxloop, page += F("</td></tr>\n");
-//    page += F("<tr><td>DMX skipped:</td><td>"); page += dmxskip, page += F("</td></tr>\n");
-//    page += F("<tr><td>micros DMX send:</td><td>"); page += micros_dmxsend, page += F("</td></tr>\n");
-//    page += F("<tr><td>debugval:</td><td>"); page += debugval, page += F("</td></tr>\n");
-//    page += F("<tr><td>debugstring:</td><td>"); page += debugstring, page += F("</td></tr>\n");
-    page += F("</table>\n");
-    page += http_foot();
-    
-    webServer.send(200, "text/html", page);
+    if (webServer.arg("reset") == "1") dmx.resetStats();
+
+    page.begin(200, "text/html");
+    http_head(PAGE_INDEX);
+//    page.print(F("<p><table style='width:100%; border:1px solid black;'>\n"));
+    page.print(F("<p><table style='width:100%;'>\n"));
+    page.print(F("<tr><td>Hostname:</td><td>")); page.print(config.hostname); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>Wifi SSID:</td><td>")); page.print(WiFi.SSID()); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>RSSI (signal strength):</td><td>")); page.print(last_rssi); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>IP:</td><td>")); page.print(IP2String(WiFi.localIP())); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>MAC:</td><td>")); page.print(WiFi.macAddress()); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>ESP-DMX version (build):</td><td>")); page.print(version_mayor); page.print("."); page.print(version_minor); page.print(" ("); page.print(build); page.print(F(")</td></tr>\n"));
+    page.print(F("<tr><td colspan=2><hr style='width:100%; height:1px; border:none; background:black;'></td><td>"));
+    page.print(F("<tr style='border-top: 1px solid black;'><td>Universe:</td><td>")); page.print(portUniverse(0)); page.print(F("</td></tr>\n"));
+    if (dmxPorts > 1) {
+        page.print(F("<tr><td>Universe port 2:</td><td>")); page.print(portUniverse(1)); page.print(F("</td></tr>\n"));
+    }
+    char routeText[ROUTE_MAX * 16];
+    routes.print(routeText, sizeof(routeText));
+    page.print(F("<tr><td>Routes:</td><td>")); page.print(routeText); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>Merge:</td><td>")); page.print((config.mergeMode == MERGE_LTP) ? F("LTP") : F("HTP"));
+    if (merge[0].merging(millis())) page.print(F(", merging"));
+    if ((dmxPorts > 1) && merge[1].merging(millis())) page.print(F(", merging port 2"));
+    page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>ArtSync:</td><td>")); page.print(artsync.active(millis()) ? F("active") : F("free running"));
+    page.print(F(" (")); page.print(artsync.syncs()); page.print(F(" received)</td></tr>\n"));
+    page.print(F("<tr><td>Channels:</td><td>")); page.print(config.channels); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>Delay:</td><td>")); page.print(config.delay); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>Seconds to hold last frame after signal loss:</td><td>")); page.print(config.holdsecs); page.print("</td></tr>\n");
+    page.print(F("<tr><td>Break / MAB (us):</td><td>")); page.print(breakTime()); page.print(" / "); page.print(mabTime()); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td colspan=2><hr style='width:100%; height:1px; border:none; background:black;'></td><td>"));
+    page.print(F("<tr><td>Artnet packets seen:</td><td>")); page.print(artnetPacketCounter); page.print(F(" (universe:"));
+    page.print(seen_universe); page.print(F(")</td></tr>\n"));
+    page.print(F("<tr><td>ArtPollReplies sent:</td><td>")); page.print(pollReply.sent()); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>sACN packets seen / invalid / ignored:</td><td>")); page.print(sacn.packets()); page.print(" / ");
+    page.print(sacn.invalid()); page.print(" / "); page.print(sacn.ignored()); page.print(F("</td></tr>\n"));
+    for (int i = 0; i < sequence.count(); i++) {
+        const seqStream *s = sequence.stream(i);
+        if (s == NULL) continue;
+        page.print(F("<tr><td>Universe ")); page.print(s->universe >> 8); page.print("."); page.print((s->universe >> 4) & 0x0f); page.print("."); page.print(s->universe & 0x0f);
+        page.print(F(" from ")); page.print(IPAddress(s->ip).toString()); page.print(F(":</td><td>"));
+        page.print(s->frames); page.print(F(" frames, ")); page.print(s->lost); page.print(F(" lost, ")); page.print(s->reordered); page.print(F(" reordered, "));
+        page.print(s->duplicates); page.print(F(" duplicate</td></tr>\n"));
+    }
+    for (int i = 0; i < senders.count(); i++) {
+        const sourceEntry *e = senders.entry(i, millis());
+        if (e == NULL) continue;
+        page.print(F("<tr><td>Sender ")); page.print(IPAddress(e->ip).toString()); page.print(e->sacn ? F(" sACN ") : F(" Art-Net "));
+        page.print(e->universe >> 8); page.print("."); page.print((e->universe >> 4) & 0x0f); page.print("."); page.print(e->universe & 0x0f); page.print(F(":</td><td>"));
+        page.print(e->pps); page.print(F(" packets/s, ")); page.print(e->bps); page.print(F(" bytes/s, seq ")); page.print(e->sequence);
+        page.print(F(", ")); page.print(e->lost); page.print(F(" lost, seen ")); page.print((millis() - e->lastSeen) / 1000); page.print(F("s ago</td></tr>\n"));
+    }
+    page.print(F("<tr><td>Artnet frames queued / coalesced / dropped:</td><td>")); page.print(artnetAccepted); page.print(" / ");
+    page.print(artnetCoalesced); page.print(" / "); page.print(artnetDropped); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>DMX frames sent:</td><td>")); page.print(dmxFrameCounter); page.print(F("</td></tr>\n"));
+    if (dmxPorts > 1) {
+        page.print(F("<tr><td>DMX frames sent port 2:</td><td>")); page.print(dmx2.frames()); page.print(F("</td></tr>\n"));
+    }
+    page.print(F("<tr><td>DMX packet length:</td><td>")); page.print(global[0].latest()->length); page.print(F(" (channels)</td></tr>\n"));
+    page.print(F("<tr><td>Latest complete / sent frame:</td><td>")); page.print(global[0].published()); page.print(" / "); page.print(global[0].sent()); page.print(F("</td></tr>\n"));
+    dmxFrameStats dmxStats = dmx.stats();
+    page.print(F("<tr><td>DMX frame period (us):</td><td>")); page.print(dmxStats.lastPeriod); page.print(F(" (configured ")); page.print(dmxStats.period); page.print(F(")</td></tr>\n"));
+    page.print(F("<tr><td>DMX frame start jitter min/avg/max (us):</td><td>")); page.print(dmxStats.jitterMin); page.print(" / ");
+    page.print((dmxStats.scheduled > 1) ? dmxStats.jitterSum / (dmxStats.scheduled - 1) : 0); page.print(" / "); page.print(dmxStats.jitterMax); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>DMX frames started late:</td><td>")); page.print(dmxStats.overruns); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>DMX frame rate full / short frames (Hz):</td><td>")); page.print(dmxFps[0]); page.print(" / "); page.print(dmxFps[1]);
+    page.print(F(" (last frame ")); page.print(dmxStats.lastLength); page.print(F(" channels)</td></tr>\n"));
+    page.print(F("<tr><td>Status:</td><td>")); page.print(status_text[status]); page.print(F("</td></tr>\n"));
+    page.print(F("<tr style='border-top: 1px solid black;'><td>Device temperature:</td><td>")); page.print(temperature); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>Fan speed (0-1024):</td><td>")); page.print(fanspeed); page.print(F("</td></tr>\n"));
+    page.print(F("<tr><td>Device uptime (s):</td><td>")); page.print(millis()/1000); page.print(F("</td></tr>\n"));
+    webFigures web = page.last();
+    page.print(F("<tr><td>Last page bytes / first chunk / total (us) / heap min:</td><td>")); page.print(web.bytes); page.print(" / ");
+    page.print(web.firstChunk); page.print(" / "); page.print(web.total); page.print(" / "); page.print(web.heapMin); page.print(F("</td></tr>\n"));
+//    page.print(F("<tr><td>DMXloop:</td><td>")); page.print(dmxloop); page.print(F("</td></tr>\n"));
+//    page.print(F("<tr><td>DMX skipped:</td><td>")); page.print(dmxskip); page.print(F("</td></tr>\n"));
+//    page.print(F("<tr><td>micros DMX send:</td><td>")); page.print(micros_dmxsend); page.print(F("</td></tr>\n"));
+//    page.print(F("<tr><td>debugval:</td><td>")); page.print(debugval); page.print(F("</td></tr>\n"));
+//    page.print(F("<tr><td>debugstring:</td><td>")); page.print(debugstring); page.print(F("</td></tr>\n"));
+    page.print(F("</table>\n"));
+    http_foot();
+    page.end();
 }
 
 
@@ -499,15 +643,143 @@ void http_index() {
 void http_pos() {
     Serial.println("HTTP: Sending index page");
 
-    String page = http_head(PAGE_INDEX);
-    page += F("<p>PowerOnShow\n");
-    page += http_foot();
-    
-    webServer.send(200, "text/html", page);
+    page.begin(200, "text/html");
+    http_head(PAGE_INDEX);
+    page.print(F("<p>PowerOnShow\n"));
+    http_foot();
+    page.end();
 
     powerOnShow(config.pOnShowCh1,config.pOnShowNumCh);
 }
 
+/*
+ * Live view of the channels, the page fetches them over the WebSocket
+ */
+void http_monitor() {
+    page.begin(200, "text/html");
+    http_head(PAGE_MONITOR);
+    htmlRender(&html_monitor, webSpan);
+    http_foot();
+    page.end();
+}
+
+/*
+ * A JSON document of len bytes straight from its buffer, without a String copy
+ */
+void sendJson(const char *json, int len) {
+    webServer.setContentLength(len);
+    webServer.send(200, "application/json", "");
+    webServer.sendContent(json, len);
+}
+
+/*
+ * Sender statistics as JSON, for monitoring
+ */
+void http_sources() {
+    static char json[SOURCE_STATS * 200];
+    int len = senders.json(json, sizeof(json), millis());
+    sendJson(json, len);
+}
+
+/*
+ * Live counters as JSON, see engineering-notes/api-status.txt
+ * Answers 304 when the ETag sent with If-None-Match still matches
+ */
+void http_api_status() {
+    static char json[API_STATUS_SIZE];
+    apiStatus s;
+    dmxFrameStats dmxStats = dmx.stats();
+    s.status = status_text[status];
+    s.rssi = last_rssi;
+    s.temperature = temperature;
+    s.fanspeed = fanspeed;
+    s.artnetPackets = artnetPacketCounter;
+    s.sacnPackets = sacn.packets();
+    s.matched = dmxUMatchCounter;
+    s.queued = artnetAccepted;
+    s.coalesced = artnetCoalesced;
+    s.dropped = artnetDropped;
+    s.lost = sequence.lost();
+    s.reordered = sequence.reordered();
+    s.duplicates = sequence.duplicates();
+    s.ports = dmxPorts;
+    s.universe[0] = portUniverse(0);
+    s.universe[1] = portUniverse(1);
+    s.frames[0] = dmxFrameCounter;
+    s.frames[1] = dmx2.frames();
+    s.fps = dmxFps[0];
+    s.fpsShort = dmxFps[1];
+    s.jitterMax = dmxStats.jitterMax;
+    s.late = dmxStats.overruns;
+    s.artsync = artsync.active(millis());
+    s.merging = merge[0].merging(millis()) || ((dmxPorts > 1) && merge[1].merging(millis()));
+    int len = apiStatusJson(&s, json, sizeof(json));
+
+    char etag[12];
+    snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long)apiEtag(json, len));
+    webServer.sendHeader("ETag", etag);
+    webServer.sendHeader("Cache-Control", "no-cache");
+    if (webServer.header("If-None-Match") == etag) {
+        webServer.send(304);
+        return;
+    }
+    sendJson(json, len);
+}
+
+/*
+ * Counters in the Prometheus text format, see metrics.h
+ */
+void http_metrics() {
+    metricsValues v;
+    dmxFrameStats dmxStats = dmx.stats();
+    v.artnetPackets = artnetPacketCounter;
+    v.sacnPackets = sacn.packets();
+    v.matched = dmxUMatchCounter;
+    v.queued = artnetAccepted;
+    v.coalesced = artnetCoalesced;
+    v.dropped = artnetDropped;
+    v.lost = sequence.lost();
+    v.reordered = sequence.reordered();
+    v.duplicates = sequence.duplicates();
+    v.ports = dmxPorts;
+    v.frames[0] = dmxFrameCounter;
+    v.frames[1] = dmx2.frames();
+    v.late = dmxStats.overruns;
+    v.period = dmxStats.lastPeriod;
+    v.jitterMax = dmxStats.jitterMax;
+    v.monitorClients = monitor.clients();
+    v.monitorFrames = monitor.frames();
+    v.monitorBytes = monitor.bytes();
+    v.monitorSkipped = monitor.skipped();
+    v.temperature = temperature;
+    v.fanspeed = fanspeed;
+    v.rssi = last_rssi;
+    v.freeHeap = ESP.getFreeHeap();
+    v.uptime = millis() / 1000;
+    page.begin(200, "text/plain; version=0.0.4");
+    metricsWrite(&v, page);
+    page.end();
+}
+
+#ifdef LOOP_PROFILE
+/*
+ * Cycles spent per stage of setup() and loop() as JSON, /profile?reset=1 starts over
+ * Written stage by stage, the whole answer does not fit a small buffer
+ */
+void http_profile() {
+    char json[PROFILE_BUCKETS * 11 + 100];
+    page.begin(200, "application/json");
+    page.printf("{\"cpu_mhz\":%u,\"stages\":[", ESP.getCpuFreqMHz());
+    for (int stage = 0; stage < PROF_STAGES; stage++) {
+        if (stage > 0) page.print(',');
+        if (profile.json(stage, json, sizeof(json))) page.print(json);
+    }
+    page.print(F("]}"));
+    page.end();
+    if (webServer.arg("reset") == "1") profile.reset();
+}
+#endif
+
 /*
  * Assemble the configuration form
  * After saving the form is displayed again with the mention 'Configuration saved'
@@ -523,9 +795,8 @@ void http_config() {
     
     Serial.print("\tHTTP: Config form");
 
-    String head = http_head(PAGE_CONFIG);
-    String body; 
-    String foot = http_foot();
+    page.begin(200, "text/html");
+    http_head(PAGE_CONFIG);
 
     if (webServer.method() == HTTP_GET) {
         Serial.println("HTTP: config form GET");
@@ -539,65 +810,55 @@ void http_config() {
             if (webServer.argName(i) == "hostname") { config.hostname = webServer.arg(i); }
             if (webServer.argName(i) == "fwURL") { config.fwURL = webServer.arg(i); }
             if (webServer.argName(i) == "universe") { config.universe = webServer.arg(i).toInt(); }
+            if (webServer.argName(i) == "universe2") { config.universe2 = webServer.arg(i).toInt(); }
+            if (webServer.argName(i) == "routes")   { config.routes = webServer.arg(i); config.routes.trim(); }
+            if (webServer.argName(i) == "ports")    { config.ports = webServer.arg(i).toInt(); }
             if (webServer.argName(i) == "channels") { config.channels = webServer.arg(i).toInt(); }
             if (webServer.argName(i) == "delay")    { config.delay = webServer.arg(i).toInt(); }
             if (webServer.argName(i) == "holdsecs") { config.holdsecs = webServer.arg(i).toInt(); }
             if (webServer.argName(i) == "pOnShowCh1") { config.pOnShowCh1 = webServer.arg(i).toInt(); }
             if (webServer.argName(i) == "pOnShowNumCh") { config.pOnShowNumCh = webServer.arg(i).toInt(); }
+            if (webServer.argName(i) == "breakus")  { config.breakus = webServer.arg(i).toInt(); }
+            if (webServer.argName(i) == "mabus")    { config.mabus = webServer.arg(i).toInt(); }
+            if (webServer.argName(i) == "shortFrames") { config.shortFrames = webServer.arg(i).toInt(); }
+            if (webServer.argName(i) == "mergeMode") { config.mergeMode = webServer.arg(i).toInt(); }
             if (webServer.argName(i) == "save")     { post_request = POST_REQUEST_SAVE; Serial.println("http_config: save"); }
             if (webServer.argName(i) == "formdefaults") { post_request = POST_REQUEST_FORMDEFAULTS; Serial.println("http_config: formdefaults"); }
             if (webServer.argName(i) == "wifidefaults") { post_request = POST_REQUEST_WIFIDEFAULTS; Serial.println("http_config: wifidefaults"); }
             if (webServer.argName(i) == "alldefaults") { post_request = POST_REQUEST_ALLDEFAULTS; Serial.println("http_config: alldefaults"); }
         }
+        if (!setBreakTiming(config.breakus, config.mabus)) {
+             // out of the E1.11 limits, keep the clamped values
+             config.breakus = breakTime();
+             config.mabus = mabTime();
+             page.print(F("<p><div style='color:red;font-weight:bold;'>Break/MAB adjusted to E1.11 limits</div><p>\n"));
+        }
+        for (int port = 0; port < DMX_PORTS; port++) merge[port].setMode(config.mergeMode);
+        if (!buildRoutes()) {
+             page.print(F("<p><div style='color:red;font-weight:bold;'>Routes not valid, ignored</div><p>\n"));
+        }
         if (post_request == POST_REQUEST_SAVE) {
              saveConfig();
              Serial.println(message);
         
-             body += F("<p><div style='color:red;font-weight:bold;'>Configuration saved</div><p>\n");
+             page.print(F("<p><div style='color:red;font-weight:bold;'>Configuration saved</div><p>\n"));
         }
         if (post_request == POST_REQUEST_FORMDEFAULTS) {
-             body += F("<p><div style='color:red;font-weight:bold;'>Resetting to default settings, retainign wifi ... Rebooting !</div><p>\n");          
+             page.print(F("<p><div style='color:red;font-weight:bold;'>Resetting to default settings, retainign wifi ... Rebooting !</div><p>\n"));          
         }
         if (post_request == POST_REQUEST_WIFIDEFAULTS) {
-             body += F("<p><div style='color:red;font-weight:bold;'>Resetting wifi config ... Rebooting !</div><p>\n");          
+             page.print(F("<p><div style='color:red;font-weight:bold;'>Resetting wifi config ... Rebooting !</div><p>\n"));          
         }
         if (post_request == POST_REQUEST_ALLDEFAULTS) {
-             body += F("<p><div style='color:red;font-weight:bold;'>Resetting to default settings including wifi ... Rebooting !</div><p>\n");          
+             page.print(F("<p><div style='color:red;font-weight:bold;'>Resetting to default settings including wifi ... Rebooting !</div><p>\n"));          
         }
     }
 
     if (post_request <= POST_REQUEST_SAVE) {
-        body += F("<form id='config' method='post' action='/config'>");
-        body += F("<p><table style='width:100%;'>\n");
-        body += F("<tr><td>Hostname:</td><td><input type='text' id='hostname' name='hostname' value='"); body += config.hostname; body += F("' required></td></tr>\n");
-        body += F("<tr><td>Universe configured:</td><td><input type='text' id='universe' name='universe' value='");
-        body += config.universe;
-        body += F("' required></td></tr>\n");
-        body += F("<tr><td>Channels configured:</td><td><input type='text' id='channels' name='channels' value='");
-        body += +config.channels;
-        body += F("' required></td></tr>\n");
-        body += F("<tr><td>Delay configured:</td><td><input type='text' id='delay' name='delay' value='");
-        body += config.delay;
-        body += F("' required></td></tr>");
-        body += F("<tr><td>Seconds to hold last state after signal loss:</td><td><input type='text' id='holdsecs' name='holdsecs' value='");
-        body += config.holdsecs;
-        body += F("' required></td></tr>");
-        body += F("<tr><td>URL for updates:</td><td><input type='text' id='fwURL' name='fwURL' value='");
-        body += config.fwURL;
-        body += F("' required></td></tr>");
-        body += F("<tr><td>PowerOnShow 1st channel:</td><td><input type='text' id='pOnShowCh1' name='pOnShowCh1' value='");
-        body += config.pOnShowCh1;
-        body += F("' required>(0=Off)</td></tr>");
-        body += F("<tr><td>PowerOnShow mode/number of channels:</td><td><input type='text' id='pOnShowNumCh' name='pOnShowNumCh' value='");
-        body += config.pOnShowNumCh;
-        body += F("' required></td></tr>");
-        body += F("<tr><td></td><td><button name='save' type='submit'>Save Config</button></td></tr>\n");
-        body += F("<tr><td colspan=2 align=center><button name='formdefaults' type='submit'>Reset config to defaults</button> ");
-        body += F("<button name='wifidefaults' type='submit'>Reset wifi config</button> ");
-        body += F("<button name='alldefaults' type='submit'>Reset config & wifi</button></td></tr>\n");
-        body += F("</table></form>\n");
+        htmlRender(&html_config, webSpan);
     }
-    webServer.send(200, "text/html", head+body+foot);
+    http_foot();
+    page.end();
 
     if (post_request == POST_REQUEST_FORMDEFAULTS) {
         defaultConfig();
@@ -630,58 +891,64 @@ void http_config() {
 void http_restart () {
     Serial.print("HTTP: Restart page ");
 
-    String head = http_head(PAGE_RESTART);
-    String body;
-    String foot = http_foot();
+    page.begin(200, "text/html");
+    http_head(PAGE_RESTART);
 
     if (webServer.method() == HTTP_GET) {
         Serial.println("GET (confirmation form)");
-        body += F("<form id='reset' method='post' action='/restart'>\n");
-        body += F("<p><table style='width:100%;text-align: center;'><tr><td><button type='submit'>Confirm Restart</button></td></tr></table></form><p>\n");
+        page.print(F("<form id='reset' method='post' action='/restart'>\n"));
+        page.print(F("<p><table style='width:100%;text-align: center;'><tr><td><button type='submit'>Confirm Restart</button></td></tr></table></form><p>\n"));
     }
     if (webServer.method() == HTTP_POST) {
         Serial.println("POST (reset)");
         Serial.println("Resetting device");
         LED.setColor(LED_RED); // red
 //        head = F("<head><title>"); head += config.hostname; head += F("</title><meta http-equiv='refresh' content='15;url=/'></head>\n");
-        body += F("<h1 style='align: center;'>Resetting ...</h1><p>\n");
-        webServer.send(200, "text/html", head+body+foot);
+        page.print(F("<h1 style='align: center;'>Resetting ...</h1><p>\n"));
+        http_foot();
+        page.end();
         
         delay(5000);
         ESP.restart();
     }
     
-    webServer.send(200, "text/html", head+body+foot);
+    http_foot();
+    page.end();
 }
 
 
 /*
  * Display the firmware update form
+ * Opening it starts a version check, the result shows on the next load
  */
 void http_update() {
     Serial.println("HTTP: Sending update form");
+    versionChecker.start(millis());
 
-    String head = http_head(PAGE_UPDATE);
-    String body;
-    body += F("<p><table style='width:100%;'>\n");
-    body += F("<tr><td>ESP-DMX current version (build):</td><td>"); body += version_mayor; body += "."; body += version_minor; body += " ("; body += build; body += F(")</td></tr>\n");
+    page.begin(200, "text/html");
+    http_head(PAGE_UPDATE);
+    page.print(F("<p><table style='width:100%;'>\n"));
+    page.print(F("<tr><td>ESP-DMX current version (build):</td><td>")); page.print(version_mayor); page.print("."); page.print(version_minor); page.print(" ("); page.print(build); page.print(F(")</td></tr>\n"));
     if (newFwAvailable) {
-        body += F("<form id=\"updateonline\" method=\"post\" action=\"/update\" enctype='multipart/form-data'>");
-        body += F("<tr><td>New online version available:</td><td>"); body += new_mayor; body += "."; body += new_minor; body += F("</td></tr>\n");
-        body += F("<tr><td></td><td><button name='updateurl' type=\"submit\">Update from online</button>&nbsp;(");
-        body += newFwURL += F(")</td></tr>");
-        body += F("</form>");
+        page.print(F("<form id=\"updateonline\" method=\"post\" action=\"/update\" enctype='multipart/form-data'>"));
+        page.print(F("<tr><td>New online version available:</td><td>")); page.print(new_mayor); page.print("."); page.print(new_minor); page.print(F("</td></tr>\n"));
+        page.print(F("<tr><td></td><td><button name='updateurl' type=\"submit\">Update from online</button>&nbsp;("));
+        page.print(newFwURL); page.print(F(")</td></tr>"));
+        page.print(F("</form>"));
     } else {
-        body += F("<tr><td></td><td>"); body += fwUpdateStatus; body += F("</td></tr>\n");    
+        page.print(F("<tr><td></td><td>")); page.print(fwUpdateStatus); page.print(F("</td></tr>\n"));    
     }
-    body += F("<form id=\"updatefile\" method=\"post\" action=\"/update\" enctype='multipart/form-data'>");
-    body += F("<tr><td>New firmware image file:</td><td><input type=\"file\" id=\"update\" name=\"update\" required></td></tr>\n");
-    body += F("<tr><td></td><td><button name='updatefile' type=\"submit\">Upload and update from File</button>");
-    body += F("</td></tr>\n</form></table><p>\n");
-
-    String foot = http_foot();
+    if (tls.handshakes()) {
+        page.print(F("<tr><td>Last TLS connect:</td><td>")); page.print(tls.handshakeTime()); page.print(F(" ms, "));
+        page.print(tls.heapUsed()); page.print(F(" bytes heap, ESP free heap ")); page.print(ESP.getFreeHeap()); page.print(F("</td></tr>\n"));
+    }
+    page.print(F("<form id=\"updatefile\" method=\"post\" action=\"/update\" enctype='multipart/form-data'>"));
+    page.print(F("<tr><td>New firmware image file:</td><td><input type=\"file\" id=\"update\" name=\"update\" required></td></tr>\n"));
+    page.print(F("<tr><td></td><td><button name='updatefile' type=\"submit\">Upload and update from File</button>"));
+    page.print(F("</td></tr>\n</form></table><p>\n"));
 
-    webServer.send(200, "text/html", head+body+foot);
+    http_foot();
+    page.end();
 }
 
 
@@ -13,6 +13,11 @@ bool loadConfig(void);
 bool saveConfig(void);
 void http_index();
 void http_pos();
+void http_monitor();
+void http_sources();
+void http_profile();
+void http_api_status();
+void http_metrics();
 void http_config();
 void http_restart();
 void http_update();
@@ -21,6 +26,9 @@ void http_dmx512png();
 void http_error404(void);
 void ota_restart(void);
 void ota_upload(void);
+void versionCheckBegin(uint32_t interval);
 bool checkForNewVersion();
+void monitorBegin();
+void monitorHandle();
 
 #endif // _WEBUI_H_